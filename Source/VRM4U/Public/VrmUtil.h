@@ -359,8 +359,18 @@ public:
 
 	bool bMobileBone = false;
 
+	// top K bone influences per vertex. 1 - 8
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U", meta = (ClampMin = 1, ClampMax = 8))
 	int BoneWeightInfluenceNum = 8;
 
+	// normalized bone weights below this are removed before renormalize
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U", meta = (ClampMin = 0, ClampMax = 0.5))
+	float BoneWeightPruneThreshold = 0.f;
+
+	// quantize bone weights to 8 bit (sum 255). UE5.2+ stores 16 bit by default
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bBoneWeight8Bit = false;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
 	EVRMImportMaterialType MaterialType = EVRMImportMaterialType::VRMIMT_Auto;
 
@@ -445,6 +455,18 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
 	bool bRemoveDegenerateTriangles = false;
 
+	// triangle order for the post-transform vertex cache, vertex order for fetch. per section
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bOptimizeVertexCache = false;
+
+	// with bOptimizeVertexCache. outward facing triangle clusters first
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bOptimizeOverdraw = false;
+
+	// vrm/glb. generate normal/tangent only when some primitive does not have them
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bSkipCompleteAttributeGeneration = true;
+
 	bool bSimpleRoot = true;
 
 	bool bActiveBone = true;
@@ -458,6 +480,58 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
 	bool bDebugNoMaterial = false;
 
+	// runtime load. decoded textures are cached on disk (Saved/VRM4U/LoadCache)
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bUseLoadCache = false;
+
+	// runtime load. block compress textures on worker threads. BC5 normal, BC7 (bBC7Mode), BC3 alpha, BC1
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bRuntimeTextureCompress = false;
+
+	// 0:fast 1:normal 2:high
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U", meta = (ClampMin = 0, ClampMax = 2))
+	int RuntimeTextureCompressQuality = 1;
+
+	// runtime load. build full mip chain on worker threads. power of two textures only
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bRuntimeGenerateMips = false;
+
+	// runtime load. textures larger than this are downscaled after decode. 0: no limit
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U", meta = (ClampMin = 0))
+	int RuntimeTextureMaxSize = 0;
+
+	// runtime load. total decoded texture size (BGRA8, with mips). largest textures are halved until it fits. 0: no limit
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U", meta = (ClampMin = 0))
+	int RuntimeTextureBudgetMB = 0;
+
+	// runtime load. same embedded images are decoded once and share one texture
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bRuntimeTextureDedup = true;
+
+	// runtime load. share same textures with other loaded models. not used with RuntimeTextureBudgetMB
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bRuntimeTextureShare = false;
+
+	// runtime load. same file and options return the already loaded asset list. VRMReleaseSharedAsset when not used
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bRuntimeShareAsset = false;
+
+	// runtime load (game build). LOD1.. by mesh simplification on worker threads. morph target vertices are kept
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	bool bRuntimeGenerateLOD = false;
+
+	// number of generated LODs. LOD0 is not included
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U", meta = (ClampMin = 1, ClampMax = 3))
+	int RuntimeLODNum = 2;
+
+	// triangle ratio to LOD0 of LOD1, LOD2, LOD3
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	TArray<float> RuntimeLODTriangleRatio = { 0.5f, 0.25f, 0.125f };
+
+	// screen size of LOD1, LOD2, LOD3
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "VRM4U")
+	TArray<float> RuntimeLODScreenSize = { 0.3f, 0.15f, 0.075f };
+
 	UPROPERTY()
 	class USkeleton* Skeleton = nullptr;
 
@@ -492,8 +566,10 @@ public:
 		TArray64<uint8> RawData;
 #endif
 		ETextureSourceFormat Format = TSF_Invalid;
+		// runtime load. RawData is block compressed when this is not PF_B8G8R8A8
+		EPixelFormat PixelFormat = PF_B8G8R8A8;
 		TextureCompressionSettings CompressionSettings = TC_Default;
-		int32 NumMips;
+		int32 NumMips = 1;
 		int32 SizeX = 0;
 		int32 SizeY = 0;
 		bool SRGB = true;
@@ -530,10 +606,49 @@ public:
 				FMemory::Memcpy(RawData.GetData(), InData, RawData.Num());
 			}
 		}
-		void Init2DWithMips(int32 InSizeX, int32 InSizeY, int32 InNumMips, ETextureSourceFormat InFormat, const void* InData = nullptr);
+		// mips are stored in RawData in order
+		void Init2DWithMips(int32 InSizeX, int32 InSizeY, int32 InNumMips, ETextureSourceFormat InFormat, const void* InData = nullptr) {
+			SizeX = InSizeX;
+			SizeY = InSizeY;
+			NumMips = InNumMips;
+			Format = InFormat;
+			int64 size = 0;
+			for (int32 i = 0; i < NumMips; ++i) {
+				size += GetMipSize(i);
+			}
+			RawData.AddUninitialized(size);
+			if (InData)
+			{
+				FMemory::Memcpy(RawData.GetData(), InData, RawData.Num());
+			}
+		}
 
-		int64 GetMipSize(int32 InMipIndex) const;
-		void* GetMipData(int32 InMipIndex);
+		int64 GetMipSize(int32 InMipIndex) const {
+			const int64 x = FMath::Max(SizeX >> InMipIndex, 1);
+			const int64 y = FMath::Max(SizeY >> InMipIndex, 1);
+			switch (PixelFormat) {
+			case PF_B8G8R8A8:
+				return x * y * GetBytesPerPixel(Format);
+			case PF_DXT1:
+			case PF_BC4:
+				return ((x + 3) / 4) * ((y + 3) / 4) * 8;
+			default:
+				return ((x + 3) / 4) * ((y + 3) / 4) * 16;
+			}
+		}
+		int64 GetMipOffset(int32 InMipIndex) const {
+			int64 offset = 0;
+			for (int32 i = 0; i < InMipIndex; ++i) {
+				offset += GetMipSize(i);
+			}
+			return offset;
+		}
+		void* GetMipData(int32 InMipIndex) {
+			return RawData.GetData() + GetMipOffset(InMipIndex);
+		}
+		const void* GetMipData(int32 InMipIndex) const {
+			return RawData.GetData() + GetMipOffset(InMipIndex);
+		}
 	};
 
 
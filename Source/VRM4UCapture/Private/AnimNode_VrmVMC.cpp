@@ -285,6 +285,7 @@ void FAnimNode_VrmVMC::EvaluateSkeletalControl_AnyThread(FComponentSpacePoseCont
 		OutBoneTransforms.Add(a);
 	}
 
+	subsystem->MarkVMCDataConsumed(VMCData, ServerAddress, Port);
 }
 
 bool FAnimNode_VrmVMC::IsValidToEvaluate(const USkeleton* Skeleton, const FBoneContainer& RequiredBones) 
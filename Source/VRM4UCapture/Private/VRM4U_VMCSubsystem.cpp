@@ -32,9 +32,47 @@ bool UVRM4U_VMCSubsystem::GetVMCData(TMap<FString, FTransform>& BoneData, TMap<F
 	BoneData = d.BoneData;
 	CurveData = d.CurveData;
 
+	MarkVMCDataConsumed(d, ServerAddress, port);
+
 	return true;
 }
 
+UVrmVMCObject* UVRM4U_VMCSubsystem::FindServer(const FString& ServerAddress, int port) {
+	for (int i = 0; i < VMCObjectList.Num(); ++i) {
+		auto a = VMCObjectList[i].Get();
+		if (a == nullptr) continue;
+
+		if (a->ServerName == ServerAddress && a->port == port) {
+			return a;
+		}
+	}
+	return nullptr;
+}
+
+void UVRM4U_VMCSubsystem::MarkVMCDataConsumed(const FVMCData& Data, FString ServerAddress, int port) {
+	auto a = FindServer(ServerAddress, port);
+	if (a) {
+		a->MarkConsumed(Data);
+	}
+}
+
+bool UVRM4U_VMCSubsystem::GetVMCLatencyStats(FVrmCaptureLatencyStats& Stats, FString ServerAddress, int port) {
+	auto a = FindServer(ServerAddress, port);
+	if (a == nullptr) {
+		Stats = FVrmCaptureLatencyStats();
+		return false;
+	}
+	a->GetLatencyStats(Stats);
+	return true;
+}
+
+void UVRM4U_VMCSubsystem::ResetVMCLatencyStats(FString ServerAddress, int port) {
+	auto a = FindServer(ServerAddress, port);
+	if (a) {
+		a->ResetLatencyStats();
+	}
+}
+
 
 UVrmVMCObject* UVRM4U_VMCSubsystem::FindOrAddServer(const FString ServerAddress, int port) {
 
@@ -0,0 +1,187 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmCaptureLatency.h"
+
+#include "HAL/PlatformTime.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/EngineVersionComparison.h"
+#include "Stats/Stats.h"
+#include "Algo/Sort.h"
+
+#if	UE_VERSION_OLDER_THAN(4,26,0)
+#define TRACE_DECLARE_FLOAT_COUNTER(a, b)
+#define TRACE_DECLARE_INT_COUNTER(a, b)
+#define TRACE_COUNTER_SET(a, b)
+#else
+#include "ProfilingDebugging/CountersTrace.h"
+#endif
+
+DECLARE_STATS_GROUP(TEXT("VRM4UCapture"), STATGROUP_VRM4UCapture, STATCAT_Advanced);
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mocopi Latency P50 (ms)"), STAT_VRM4U_MocopiLatencyP50, STATGROUP_VRM4UCapture);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Mocopi Latency P99 (ms)"), STAT_VRM4U_MocopiLatencyP99, STATGROUP_VRM4UCapture);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mocopi Dropped"), STAT_VRM4U_MocopiDropped, STATGROUP_VRM4UCapture);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Mocopi Overwritten"), STAT_VRM4U_MocopiOverwritten, STATGROUP_VRM4UCapture);
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("VMC Latency P50 (ms)"), STAT_VRM4U_VMCLatencyP50, STATGROUP_VRM4UCapture);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("VMC Latency P99 (ms)"), STAT_VRM4U_VMCLatencyP99, STATGROUP_VRM4UCapture);
+DECLARE_DWORD_COUNTER_STAT(TEXT("VMC Dropped"), STAT_VRM4U_VMCDropped, STATGROUP_VRM4UCapture);
+DECLARE_DWORD_COUNTER_STAT(TEXT("VMC Overwritten"), STAT_VRM4U_VMCOverwritten, STATGROUP_VRM4UCapture);
+
+TRACE_DECLARE_FLOAT_COUNTER(VRM4U_MocopiLatency, TEXT("VRM4U/Mocopi/LatencyMs"));
+TRACE_DECLARE_INT_COUNTER(VRM4U_MocopiDropped, TEXT("VRM4U/Mocopi/Dropped"));
+TRACE_DECLARE_FLOAT_COUNTER(VRM4U_VMCLatency, TEXT("VRM4U/VMC/LatencyMs"));
+TRACE_DECLARE_INT_COUNTER(VRM4U_VMCDropped, TEXT("VRM4U/VMC/Dropped"));
+
+namespace {
+	float CyclesToMs(uint64 From, uint64 To) {
+		if (From == 0 || To < From) {
+			return 0.f;
+		}
+		return (float)FPlatformTime::ToMilliseconds64(To - From);
+	}
+
+	void CalcPercentile(TArray<float>& Values, float& P50, float& P99) {
+		P50 = P99 = 0.f;
+		if (Values.Num() == 0) {
+			return;
+		}
+		Algo::Sort(Values);
+		const int Last = Values.Num() - 1;
+		P50 = Values[FMath::Clamp(FMath::RoundToInt(Last * 0.50f), 0, Last)];
+		P99 = Values[FMath::Clamp(FMath::RoundToInt(Last * 0.99f), 0, Last)];
+	}
+}
+
+FVrmCaptureLatencyTracker::FVrmCaptureLatencyTracker(EVrmCaptureSource InSource)
+	: Source(InSource) {
+	SampleList.Reserve(SampleMax);
+}
+
+void FVrmCaptureLatencyTracker::Publish(FVrmCaptureTimestamp& Stamp) {
+	FScopeLock lock(&cs);
+
+	Stamp.Sequence = NextSequence++;
+	Stamp.PublishCycles = FPlatformTime::Cycles64();
+	++PublishedCount;
+}
+
+void FVrmCaptureLatencyTracker::Evict(const FVrmCaptureTimestamp& Stamp) {
+	FScopeLock lock(&cs);
+
+	if (Stamp.Sequence <= LastAccountedSequence) {
+		return;
+	}
+	LastAccountedSequence = Stamp.Sequence;
+	++DroppedCount;
+}
+
+void FVrmCaptureLatencyTracker::Overwrite(const FVrmCaptureTimestamp& Stamp) {
+	FScopeLock lock(&cs);
+
+	if (Stamp.Sequence <= LastAccountedSequence) {
+		return;
+	}
+	LastAccountedSequence = Stamp.Sequence;
+	++OverwrittenCount;
+}
+
+void FVrmCaptureLatencyTracker::Consume(const FVrmCaptureTimestamp& Stamp) {
+	const uint64 Now = FPlatformTime::Cycles64();
+
+	FScopeLock lock(&cs);
+
+	if (Stamp.Sequence == 0 || Stamp.Sequence <= LastAccountedSequence) {
+		return;
+	}
+	// frames between the last read one and this one were skipped by the reader
+	OverwrittenCount += (int32)(Stamp.Sequence - LastAccountedSequence - 1);
+	LastAccountedSequence = Stamp.Sequence;
+	++ConsumedCount;
+
+	FSample s;
+	s.ReceiveToParse = CyclesToMs(Stamp.ReceiveCycles, Stamp.ParseCycles);
+	s.ParseToPublish = CyclesToMs(Stamp.ParseCycles, Stamp.PublishCycles);
+	s.PublishToConsume = CyclesToMs(Stamp.PublishCycles, Now);
+	s.Total = CyclesToMs(Stamp.ReceiveCycles ? Stamp.ReceiveCycles : Stamp.PublishCycles, Now);
+
+	if (SampleList.Num() < SampleMax) {
+		SampleList.Add(s);
+	} else {
+		SampleList[SampleWritePos] = s;
+	}
+	SampleWritePos = (SampleWritePos + 1) % SampleMax;
+
+	if (Source == EVrmCaptureSource::Mocopi) {
+		TRACE_COUNTER_SET(VRM4U_MocopiLatency, s.Total);
+		TRACE_COUNTER_SET(VRM4U_MocopiDropped, DroppedCount);
+	} else {
+		TRACE_COUNTER_SET(VRM4U_VMCLatency, s.Total);
+		TRACE_COUNTER_SET(VRM4U_VMCDropped, DroppedCount);
+	}
+
+	if ((ConsumedCount % StatUpdateInterval) == 0) {
+		UpdateStats_Locked();
+	}
+}
+
+void FVrmCaptureLatencyTracker::GetStats(FVrmCaptureLatencyStats& Out) const {
+	FScopeLock lock(&cs);
+	GetStats_Locked(Out);
+}
+
+void FVrmCaptureLatencyTracker::GetStats_Locked(FVrmCaptureLatencyStats& Out) const {
+	Out = FVrmCaptureLatencyStats();
+
+	Out.SampleNum = SampleList.Num();
+	Out.PublishedCount = PublishedCount;
+	Out.ConsumedCount = ConsumedCount;
+	Out.DroppedCount = DroppedCount;
+	Out.OverwrittenCount = OverwrittenCount;
+
+	TArray<float> v;
+	v.SetNumUninitialized(SampleList.Num());
+
+	for (int i = 0; i < SampleList.Num(); ++i) v[i] = SampleList[i].ReceiveToParse;
+	CalcPercentile(v, Out.ReceiveToParseP50, Out.ReceiveToParseP99);
+
+	for (int i = 0; i < SampleList.Num(); ++i) v[i] = SampleList[i].ParseToPublish;
+	CalcPercentile(v, Out.ParseToPublishP50, Out.ParseToPublishP99);
+
+	for (int i = 0; i < SampleList.Num(); ++i) v[i] = SampleList[i].PublishToConsume;
+	CalcPercentile(v, Out.PublishToConsumeP50, Out.PublishToConsumeP99);
+
+	for (int i = 0; i < SampleList.Num(); ++i) v[i] = SampleList[i].Total;
+	CalcPercentile(v, Out.TotalP50, Out.TotalP99);
+}
+
+void FVrmCaptureLatencyTracker::UpdateStats_Locked() const {
+#if STATS
+	FVrmCaptureLatencyStats s;
+	GetStats_Locked(s);
+
+	if (Source == EVrmCaptureSource::Mocopi) {
+		SET_FLOAT_STAT(STAT_VRM4U_MocopiLatencyP50, s.TotalP50);
+		SET_FLOAT_STAT(STAT_VRM4U_MocopiLatencyP99, s.TotalP99);
+		SET_DWORD_STAT(STAT_VRM4U_MocopiDropped, s.DroppedCount);
+		SET_DWORD_STAT(STAT_VRM4U_MocopiOverwritten, s.OverwrittenCount);
+	} else {
+		SET_FLOAT_STAT(STAT_VRM4U_VMCLatencyP50, s.TotalP50);
+		SET_FLOAT_STAT(STAT_VRM4U_VMCLatencyP99, s.TotalP99);
+		SET_DWORD_STAT(STAT_VRM4U_VMCDropped, s.DroppedCount);
+		SET_DWORD_STAT(STAT_VRM4U_VMCOverwritten, s.OverwrittenCount);
+	}
+#endif
+}
+
+void FVrmCaptureLatencyTracker::Reset() {
+	FScopeLock lock(&cs);
+
+	SampleList.Reset();
+	SampleWritePos = 0;
+	LastAccountedSequence = NextSequence - 1;
+	PublishedCount = 0;
+	ConsumedCount = 0;
+	DroppedCount = 0;
+	OverwrittenCount = 0;
+}
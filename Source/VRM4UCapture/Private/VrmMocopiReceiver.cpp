@@ -7,6 +7,7 @@
 
 #include "CoreGlobals.h"
 #include "Stats/Stats.h"
+#include "HAL/PlatformTime.h"
 #include "Tickable.h"
 #include "Common/UdpSocketReceiver.h"
 //
@@ -96,6 +97,8 @@ TStatId FMocopiReceiverProxy::GetStatId() const
 
 void FMocopiReceiverProxy::OnPacketReceived(const FArrayReaderPtr& InData, const FIPv4Endpoint& InEndpoint) {
 
+	const uint64 ReceiveCycles = FPlatformTime::Cycles64();
+
 	RecvDataSet.Append(InData->GetData(), InData->Num());
 
 	// data size limit
@@ -404,35 +407,15 @@ void FMocopiReceiverProxy::OnPacketReceived(const FArrayReaderPtr& InData, const
 		md.VrmTransformLocal = d.transformVrmLocal;
 
 		{
-			TMap<FString, int> BoneIdList = {
-			{"hips",				0},
-			{"leftUpperLeg",		19},
-			{"rightUpperLeg",		23},
-			{"leftLowerLeg",		20},
-			{"rightLowerLeg",		24},
-			{"leftFoot",			21},
-			{"rightFoot",			25},
-			{"spine",				3},	//
-			{"chest",				6},	//
-			{"upperChest",			7},	//
-			{"neck",				8}, //
-			{"head",				9},
-			{"leftShoulder",		11},
-			{"rightShoulder",		15},
-			{"leftUpperArm",		12},
-			{"rightUpperArm",		16},
-			{"leftLowerArm",		13},
-			{"rightLowerArm",		17},
-			{"leftHand",			14},
-			{"rightHand",			18},
-			{"leftToes",			22},
-			{"rightToes",			26},
-			};
+			const auto BoneIdList = FVrmMocopiRetargetTable::GetHumanoidJointTable();
 
+			md.VrmTransformBoneList.Reserve(BoneIdList.Num());
 			for (auto& b : BoneIdList) {
-				md.VrmTransformBoneList.Add(b.Key, d.transformVrmLocal[b.Value]);
+				md.VrmTransformBoneList.Add(b.HumanoidName, d.transformVrmLocal[b.MocopiIndex]);
 			}
 		}
+		md.Timestamp.ReceiveCycles = ReceiveCycles;
+		md.Timestamp.ParseCycles = FPlatformTime::Cycles64();
 
 		if (Receiver) {
 			Receiver->OnPacketReceived(md);
@@ -518,6 +501,8 @@ void UVrmMocopiReceiver::GetNextFrameData(FStructMocopiData &data, bool &bEnable
 	currentFrameNo = data.FrameNo;
 	currentTime = data.Time;
 	bEnable = true;
+
+	LatencyTracker.Consume(data.Timestamp);
 }
 
 void UVrmMocopiReceiver::GetLatestFrameData(FStructMocopiData &data, bool &bEnable, bool &bUpdate){
@@ -538,6 +523,58 @@ void UVrmMocopiReceiver::GetLatestFrameData(FStructMocopiData &data, bool &bEnab
 	currentTime = data.Time;
 	bEnable = true;
 
+	LatencyTracker.Consume(data.Timestamp);
+}
+
+const FVrmMocopiRetargetTable* UVrmMocopiReceiver::FindOrBuildRetargetTable(const UVrmMetaObject* MetaObject) {
+	if (MetaObject == nullptr) {
+		return nullptr;
+	}
+	// new meta object. drop tables of released ones
+	if (RetargetTableCache.Contains(FObjectKey(MetaObject)) == false) {
+		for (auto it = RetargetTableCache.CreateIterator(); it; ++it) {
+			if (it->Key.ResolveObjectPtr() == nullptr) {
+				it.RemoveCurrent();
+			}
+		}
+	}
+	FVrmMocopiRetargetTable& table = RetargetTableCache.FindOrAdd(FObjectKey(MetaObject));
+	if (table.IsValid() == false) {
+		if (table.Build(MetaObject) == false) {
+			RetargetTableCache.Remove(FObjectKey(MetaObject));
+			return nullptr;
+		}
+	}
+	return &table;
+}
+
+void UVrmMocopiReceiver::GetLatestFrameVrmPose(const UVrmMetaObject* MetaObject, FVrmMocopiPose& Pose, bool& bEnable, bool& bUpdate) {
+	bEnable = false;
+	bUpdate = false;
+
+	const FVrmMocopiRetargetTable* table = FindOrBuildRetargetTable(MetaObject);
+	if (table == nullptr) {
+		return;
+	}
+
+	FScopeLock ScopeLock(&BufferCS);
+
+	if (MocopiReceiveBuffer.Num() <= 0) {
+		return;
+	}
+	const FStructMocopiData& data = MocopiReceiveBuffer.Last();
+
+	// convert in place, no frame copy
+	table->Convert(data, Pose);
+
+	if (data.FrameNo != currentFrameNo) {
+		bUpdate = true;
+	}
+	currentFrameNo = data.FrameNo;
+	currentTime = data.Time;
+	bEnable = true;
+
+	LatencyTracker.Consume(data.Timestamp);
 }
 
 void UVrmMocopiReceiver::PacketBroadcast() {
@@ -552,12 +589,22 @@ void UVrmMocopiReceiver::OnPacketReceived(FStructMocopiData data) {
 		if (MocopiReceiveBuffer.Num()  == 0) {
 			break;
 		}
+		LatencyTracker.Evict(MocopiReceiveBuffer[0].Timestamp);
 #if	UE_VERSION_OLDER_THAN(4,26,0)
 		MocopiReceiveBuffer.RemoveAt(0);
 #else
 		MocopiReceiveBuffer.PopFront();
 #endif
 	}
+	LatencyTracker.Publish(data.Timestamp);
 	MocopiReceiveBuffer.Add(data);
 }
 
+void UVrmMocopiReceiver::GetLatencyStats(FVrmCaptureLatencyStats& Stats) const {
+	LatencyTracker.GetStats(Stats);
+}
+
+void UVrmMocopiReceiver::ResetLatencyStats() {
+	LatencyTracker.Reset();
+}
+
@@ -0,0 +1,159 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmMocopiRetarget.h"
+#include "VrmMocopiReceiver.h"
+
+#include "VrmMetaObject.h"
+#include "VrmUtil.h"
+#include "Engine/SkeletalMesh.h"
+
+namespace {
+	const FVrmMocopiRetargetTable::FHumanoidJoint HumanoidJointTable[] = {
+		{TEXT("hips"),				0},
+		{TEXT("leftUpperLeg"),		19},
+		{TEXT("rightUpperLeg"),		23},
+		{TEXT("leftLowerLeg"),		20},
+		{TEXT("rightLowerLeg"),		24},
+		{TEXT("leftFoot"),			21},
+		{TEXT("rightFoot"),			25},
+		{TEXT("spine"),				3},
+		{TEXT("chest"),				6},
+		{TEXT("upperChest"),		7},
+		{TEXT("neck"),				8},
+		{TEXT("head"),				9},
+		{TEXT("leftShoulder"),		11},
+		{TEXT("rightShoulder"),		15},
+		{TEXT("leftUpperArm"),		12},
+		{TEXT("rightUpperArm"),		16},
+		{TEXT("leftLowerArm"),		13},
+		{TEXT("rightLowerArm"),		17},
+		{TEXT("leftHand"),			14},
+		{TEXT("rightHand"),			18},
+		{TEXT("leftToes"),			22},
+		{TEXT("rightToes"),			26},
+	};
+
+	const FString* FindModelBoneName(const UVrmMetaObject* MetaObject, const TCHAR* HumanoidName) {
+		const FString* ret = MetaObject->humanoidBoneTable.Find(HumanoidName);
+		if (ret) {
+			return ret;
+		}
+		for (const auto& t : MetaObject->humanoidBoneTable) {
+			if (t.Key.Compare(HumanoidName, ESearchCase::IgnoreCase) == 0) {
+				return &t.Value;
+			}
+		}
+		return nullptr;
+	}
+}
+
+TArrayView<const FVrmMocopiRetargetTable::FHumanoidJoint> FVrmMocopiRetargetTable::GetHumanoidJointTable() {
+	return TArrayView<const FHumanoidJoint>(HumanoidJointTable, UE_ARRAY_COUNT(HumanoidJointTable));
+}
+
+bool FVrmMocopiRetargetTable::Build(const UVrmMetaObject* InMetaObject, bool bRestPoseCorrection) {
+	*this = FVrmMocopiRetargetTable();
+
+	if (InMetaObject == nullptr || InMetaObject->SkeletalMesh == nullptr) {
+		return false;
+	}
+	const FReferenceSkeleton& RefSkeleton = VRMGetRefSkeleton(InMetaObject->SkeletalMesh);
+	const TArray<FTransform>& RefPose = RefSkeleton.GetRefBonePose();
+
+	TArray<FQuat> RefGlobalRotation;
+	RefGlobalRotation.SetNum(RefPose.Num());
+	for (int i = 0; i < RefPose.Num(); ++i) {
+		const int parent = RefSkeleton.GetParentIndex(i);
+		RefGlobalRotation[i] = RefPose[i].GetRotation();
+		if (parent >= 0) {
+			RefGlobalRotation[i] = RefGlobalRotation[parent] * RefGlobalRotation[i];
+		}
+	}
+
+	const int32 JointNum = UE_ARRAY_COUNT(HumanoidJointTable);
+	BoneName.Reserve(JointNum);
+	BoneIndex.Reserve(JointNum);
+	MocopiIndex.Reserve(JointNum);
+	PreRotation.Reserve(JointNum);
+	PostRotation.Reserve(JointNum);
+	RefTranslation.Reserve(JointNum);
+
+	for (const auto& j : HumanoidJointTable) {
+		const FString* modelName = FindModelBoneName(InMetaObject, j.HumanoidName);
+		if (modelName == nullptr) continue;
+
+		const int32 index = RefSkeleton.FindBoneIndex(**modelName);
+		if (index < 0) continue;
+
+		// same correction as FAnimNode_VrmVMC::bIgnoreLocalRotation
+		//   ref_local * ref_global^-1 * src * ref_global
+		FQuat pre = FQuat::Identity;
+		FQuat post = FQuat::Identity;
+		if (bRestPoseCorrection) {
+			pre = RefPose[index].GetRotation() * RefGlobalRotation[index].Inverse();
+			post = RefGlobalRotation[index];
+		}
+
+		BoneName.Add(RefSkeleton.GetBoneName(index));
+		BoneIndex.Add(index);
+		MocopiIndex.Add(j.MocopiIndex);
+		PreRotation.Add(pre);
+		PostRotation.Add(post);
+		RefTranslation.Add(RefPose[index].GetTranslation());
+	}
+
+	MetaObject = InMetaObject;
+	SkeletalMesh = InMetaObject->SkeletalMesh;
+	SkeletonHash = GetSkeletonHash(RefSkeleton);
+	return BoneIndex.Num() > 0;
+}
+
+uint32 FVrmMocopiRetargetTable::GetSkeletonHash(const FReferenceSkeleton& RefSkeleton) {
+	uint32 hash = GetTypeHash(RefSkeleton.GetRawBoneNum());
+	for (int32 i = 0; i < RefSkeleton.GetRawBoneNum(); ++i) {
+		hash = HashCombine(hash, GetTypeHash(RefSkeleton.GetBoneName(i)));
+		hash = HashCombine(hash, GetTypeHash(RefSkeleton.GetParentIndex(i)));
+	}
+	return hash;
+}
+
+bool FVrmMocopiRetargetTable::IsValid() const {
+	const UVrmMetaObject* m = MetaObject.Get();
+	if (m == nullptr || m->SkeletalMesh == nullptr || m->SkeletalMesh != SkeletalMesh.Get()) {
+		return false;
+	}
+	return GetSkeletonHash(VRMGetRefSkeleton(m->SkeletalMesh)) == SkeletonHash;
+}
+
+void FVrmMocopiRetargetTable::Convert(const FStructMocopiData& Src, FVrmMocopiPose& Dst) const {
+	const int32 SlotNum = BoneIndex.Num();
+
+	// layout only changes when the table is rebuilt
+	if (Dst.BoneIndex != BoneIndex) {
+		Dst.BoneIndex = BoneIndex;
+		Dst.BoneName = BoneName;
+	}
+	Dst.BoneTransform.SetNum(SlotNum);
+	Dst.FrameNo = Src.FrameNo;
+
+	if (Src.VrmTransformLocal.Num() < MocopiData::BoneNum) {
+		return;
+	}
+
+	const FTransform* In = Src.VrmTransformLocal.GetData();
+	FTransform* Out = Dst.BoneTransform.GetData();
+	const int32* Mocopi = MocopiIndex.GetData();
+	const FQuat* Pre = PreRotation.GetData();
+	const FQuat* Post = PostRotation.GetData();
+	const FVector* RefTrans = RefTranslation.GetData();
+
+	for (int32 i = 0; i < SlotNum; ++i) {
+		const FTransform& t = In[Mocopi[i]];
+		Out[i].SetComponents(Pre[i] * t.GetRotation() * Post[i], RefTrans[i], FVector::OneVector);
+	}
+
+	// hips carry the tracked position
+	if (SlotNum > 0 && Mocopi[0] == 0) {
+		Out[0].SetTranslation(In[0].GetTranslation());
+	}
+}
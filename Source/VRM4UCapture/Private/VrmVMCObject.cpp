@@ -7,6 +7,7 @@
 #include "Engine/Engine.h"
 #include "UObject/StrongObjectPtr.h"
 #include "Misc/ScopeLock.h"
+#include "HAL/PlatformTime.h"
 #include "OSCManager.h"
 #include "OSCServer.h"
 
@@ -37,6 +38,11 @@ void UVrmVMCObject::CreateServer(FString inName, uint16 inPort) {
 
 void UVrmVMCObject::OSCReceivedMessageEvent(const FOSCMessage& Message, const FString& IPAddress, uint16 Port) {
 
+	// first message of a new frame
+	if (VMCData.Timestamp.ReceiveCycles == 0) {
+		VMCData.Timestamp.ReceiveCycles = FPlatformTime::Cycles64();
+	}
+
 	FOSCAddress a = UOSCManager::GetOSCMessageAddress(Message);
 	FString addressPath = UOSCManager::GetOSCAddressFullPath(a);
 
@@ -73,6 +79,8 @@ void UVrmVMCObject::OSCReceivedMessageEvent(const FOSCMessage& Message, const FS
 	}
 
 	if (bDataUpdated == true){
+		VMCData.Timestamp.ParseCycles = FPlatformTime::Cycles64();
+
 		bool b = bForceUpdate;
 		if (addressPath == TEXT("/VMC/Ext/OK")) {
 			b = true;
@@ -86,7 +94,12 @@ void UVrmVMCObject::OSCReceivedMessageEvent(const FOSCMessage& Message, const FS
 		
 		if (b) {
 			FScopeLock lock(&cs);
+			if (VMCData_Cache.Timestamp.Sequence) {
+				LatencyTracker.Overwrite(VMCData_Cache.Timestamp);
+			}
+			LatencyTracker.Publish(VMCData.Timestamp);
 			VMCData_Cache = VMCData;
+			VMCData.Timestamp.Reset();
 			bDataUpdated = false;
 		}
 	}
@@ -104,3 +117,15 @@ void UVrmVMCObject::ClearVMCData() {
 	VMCData_Cache.ClearData();
 }
 
+void UVrmVMCObject::MarkConsumed(const FVMCData& data) {
+	LatencyTracker.Consume(data.Timestamp);
+}
+
+void UVrmVMCObject::GetLatencyStats(FVrmCaptureLatencyStats& Stats) const {
+	LatencyTracker.GetStats(Stats);
+}
+
+void UVrmVMCObject::ResetLatencyStats() {
+	LatencyTracker.Reset();
+}
+
@@ -48,8 +48,18 @@ public:
 	UFUNCTION(BlueprintCallable, Category = VRM4U)
 	bool GetVMCData(TMap<FString, FTransform> &BoneData, TMap<FString, float> &CurveData, FString ServerAddress, int port);
 
+	// call after the copied data has been applied to the pose
+	void MarkVMCDataConsumed(const FVMCData& Data, FString ServerAddress, int port);
+
+	UFUNCTION(BlueprintCallable, Category = VRM4U)
+	bool GetVMCLatencyStats(FVrmCaptureLatencyStats& Stats, FString ServerAddress, int port);
+
+	UFUNCTION(BlueprintCallable, Category = VRM4U)
+	void ResetVMCLatencyStats(FString ServerAddress, int port);
+
 
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 
 private:
+	UVrmVMCObject* FindServer(const FString& ServerAddress, int port);
 };
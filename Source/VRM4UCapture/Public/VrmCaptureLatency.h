@@ -0,0 +1,136 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+#include "VrmCaptureLatency.generated.h"
+
+/**
+ * Latency summary of a capture source (mocopi / VMC).
+ * Stage times are in milliseconds, sampled from the most recent consumed frames.
+ */
+USTRUCT(BlueprintType)
+struct FVrmCaptureLatencyStats {
+	GENERATED_BODY()
+
+	// datagram/message arrival -> frame parsed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float ReceiveToParseP50 = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float ReceiveToParseP99 = 0.f;
+
+	// frame parsed -> stored in the receive buffer
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float ParseToPublishP50 = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float ParseToPublishP99 = 0.f;
+
+	// stored in the receive buffer -> read by a consumer (anim node / blueprint)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float PublishToConsumeP50 = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float PublishToConsumeP99 = 0.f;
+
+	// arrival -> consumed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float TotalP50 = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float TotalP99 = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 SampleNum = 0;
+
+	// frames stored in the receive buffer
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 PublishedCount = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 ConsumedCount = 0;
+
+	// evicted from the receive buffer before any consumer read them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 DroppedCount = 0;
+
+	// replaced by a newer frame before any consumer read them
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 OverwrittenCount = 0;
+};
+
+enum class EVrmCaptureSource : uint8 {
+	Mocopi,
+	VMC,
+};
+
+/**
+ * Per frame timestamps. FPlatformTime::Cycles64() based, 0 == not stamped.
+ */
+struct FVrmCaptureTimestamp {
+	uint64 Sequence = 0;
+	uint64 ReceiveCycles = 0;
+	uint64 ParseCycles = 0;
+	uint64 PublishCycles = 0;
+
+	void Reset() {
+		*this = FVrmCaptureTimestamp();
+	}
+};
+
+/**
+ * Collects stage latencies and drop/overwrite counts of one capture source.
+ * Thread safe. Publish/Evict are called from the receiver, Consume from the reader.
+ */
+class VRM4UCAPTURE_API FVrmCaptureLatencyTracker {
+public:
+	FVrmCaptureLatencyTracker(EVrmCaptureSource InSource);
+
+	// assign a sequence number and stamp publish time
+	void Publish(FVrmCaptureTimestamp& Stamp);
+
+	// a published frame was removed from the buffer
+	void Evict(const FVrmCaptureTimestamp& Stamp);
+
+	// a published frame was replaced in place by a newer one
+	void Overwrite(const FVrmCaptureTimestamp& Stamp);
+
+	// a frame was read by a consumer. re-reading the same frame is ignored
+	void Consume(const FVrmCaptureTimestamp& Stamp);
+
+	void GetStats(FVrmCaptureLatencyStats& Out) const;
+	void Reset();
+
+private:
+	enum {
+		SampleMax = 256,
+		StatUpdateInterval = 30,
+	};
+	struct FSample {
+		float ReceiveToParse = 0.f;
+		float ParseToPublish = 0.f;
+		float PublishToConsume = 0.f;
+		float Total = 0.f;
+	};
+
+	void GetStats_Locked(FVrmCaptureLatencyStats& Out) const;
+	void UpdateStats_Locked() const;
+
+	mutable FCriticalSection cs;
+
+	EVrmCaptureSource Source;
+
+	TArray<FSample> SampleList;
+	int SampleWritePos = 0;
+
+	uint64 NextSequence = 1;
+	uint64 LastAccountedSequence = 0;
+
+	int32 PublishedCount = 0;
+	int32 ConsumedCount = 0;
+	int32 DroppedCount = 0;
+	int32 OverwrittenCount = 0;
+};
@@ -19,6 +19,10 @@
 #include "Containers/RingBuffer.h"
 #endif
 
+#include "VrmCaptureLatency.h"
+#include "VrmMocopiRetarget.h"
+#include "UObject/ObjectKey.h"
+
 #include "VrmMocopiReceiver.generated.h"
 
 /**
@@ -52,6 +56,8 @@ struct FStructMocopiData{
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
 	TMap<FString, FTransform> VrmTransformBoneList;
 
+	FVrmCaptureTimestamp Timestamp;
+
 	FStructMocopiData() {
 		MocopiTransformWorld.SetNum(MocopiData::BoneNum);
 		MocopiTransformLocal.SetNum(MocopiData::BoneNum);
@@ -113,6 +119,10 @@ class VRM4UCAPTURE_API UVrmMocopiReceiver : public UObject
 	TRingBuffer<FStructMocopiData> MocopiReceiveBuffer;
 #endif
 
+	FVrmCaptureLatencyTracker LatencyTracker{ EVrmCaptureSource::Mocopi };
+
+	TMap<FObjectKey, FVrmMocopiRetargetTable> RetargetTableCache;
+
 public:
 
 	UFUNCTION(BlueprintCallable, Category = "VRM4U")
@@ -144,12 +154,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "VRM4U")
 	void GetLatestFrameData(FStructMocopiData &data, bool &bEnable, bool &bUpdate);
 
+	// latest frame converted to the bones of MetaObject's skeletal mesh
+	UFUNCTION(BlueprintCallable, Category = "VRM4U")
+	void GetLatestFrameVrmPose(const UVrmMetaObject* MetaObject, FVrmMocopiPose& Pose, bool& bEnable, bool& bUpdate);
+
+	const FVrmMocopiRetargetTable* FindOrBuildRetargetTable(const UVrmMetaObject* MetaObject);
+
 	UFUNCTION(BlueprintCallable, Category = "VRM4U")
 	void GetCurrentTime(int& FrameNo, int& Time) {
 		FrameNo = currentFrameNo;
 		Time = currentTime;
 	}
 
+	UFUNCTION(BlueprintCallable, Category = "VRM4U")
+	void GetLatencyStats(FVrmCaptureLatencyStats& Stats) const;
+
+	UFUNCTION(BlueprintCallable, Category = "VRM4U")
+	void ResetLatencyStats();
+
 protected:
 	virtual void BeginDestroy() override;
 
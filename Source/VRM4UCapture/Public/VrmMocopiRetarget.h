@@ -0,0 +1,71 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtr.h"
+
+#include "VrmMocopiRetarget.generated.h"
+
+class UVrmMetaObject;
+class USkeletalMesh;
+struct FReferenceSkeleton;
+struct FStructMocopiData;
+
+/**
+ * Compact VRM pose converted from one mocopi frame.
+ * BoneTransform is local (parent bone space), aligned with BoneName/BoneIndex.
+ */
+USTRUCT(BlueprintType)
+struct VRM4UCAPTURE_API FVrmMocopiPose {
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	TArray<FName> BoneName;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	TArray<FTransform> BoneTransform;
+
+	// reference skeleton index of the target mesh
+	TArray<int32> BoneIndex;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int FrameNo = 0;
+};
+
+/**
+ * mocopi joint -> VRM humanoid bone table, built once per UVrmMetaObject.
+ */
+class VRM4UCAPTURE_API FVrmMocopiRetargetTable {
+public:
+	struct FHumanoidJoint {
+		const TCHAR* HumanoidName;
+		int32 MocopiIndex;
+	};
+
+	// humanoid bones driven by mocopi. hips first
+	static TArrayView<const FHumanoidJoint> GetHumanoidJointTable();
+
+	bool Build(const UVrmMetaObject* MetaObject, bool bRestPoseCorrection = true);
+
+	// same mesh and same bone hierarchy as the build
+	bool IsValid() const;
+
+	// bone names and parents
+	static uint32 GetSkeletonHash(const FReferenceSkeleton& RefSkeleton);
+
+	void Convert(const FStructMocopiData& Src, FVrmMocopiPose& Dst) const;
+
+private:
+	TWeakObjectPtr<const UVrmMetaObject> MetaObject;
+	TWeakObjectPtr<const USkeletalMesh> SkeletalMesh;
+	uint32 SkeletonHash = 0;
+
+	// per slot (structure of arrays)
+	TArray<FName> BoneName;
+	TArray<int32> BoneIndex;
+	TArray<int32> MocopiIndex;
+	TArray<FQuat> PreRotation;
+	TArray<FQuat> PostRotation;
+	TArray<FVector> RefTranslation;
+};
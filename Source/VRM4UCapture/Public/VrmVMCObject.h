@@ -6,6 +6,7 @@
 #include "Misc/EngineVersionComparison.h"
 #include "UObject/StrongObjectPtr.h"
 #include "OSCServer.h"	// for game build link error
+#include "VrmCaptureLatency.h"
 
 #include "VrmVMCObject.generated.h"
 
@@ -18,9 +19,12 @@ struct FVMCData {
 	TMap<FString, FTransform> BoneData;
 	TMap<FString, float> CurveData;
 
+	FVrmCaptureTimestamp Timestamp;
+
 	void ClearData() {
 		BoneData.Empty();
 		CurveData.Empty();
+		Timestamp.Reset();
 	}
 
 	bool operator==(const FVMCData& Other) const {
@@ -44,6 +48,8 @@ class VRM4UCAPTURE_API UVrmVMCObject : public UObject
 	FVMCData VMCData_Cache;
 
 	bool bDataUpdated = false;
+
+	FVrmCaptureLatencyTracker LatencyTracker{ EVrmCaptureSource::VMC };
 public:
 
 
@@ -58,4 +64,8 @@ public:
 
 	bool CopyVMCData(FVMCData& dst);
 	void ClearVMCData();
+
+	void MarkConsumed(const FVMCData& data);
+	void GetLatencyStats(FVrmCaptureLatencyStats& Stats) const;
+	void ResetLatencyStats();
 };
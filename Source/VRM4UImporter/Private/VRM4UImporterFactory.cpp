@@ -37,6 +37,7 @@
 #include "VrmConvert.h"
 #include "VrmLicenseObject.h"
 #include "Vrm1LicenseObject.h"
+#include "JsonObjectConverter.h"
 
 #define LOCTEXT_NAMESPACE "VRMImporter"
 
@@ -620,6 +621,10 @@ UVrmImportUI::UVrmImportUI(const FObjectInitializer& ObjectInitializer)
 
 void UVrmImportUI::ParseFromJson(TSharedRef<class FJsonObject> ImportSettingsJson)
 {
+	// option preset. same names as the properties of this class
+	const int64 SkipFlags = CPF_InstancedReference;
+	FJsonObjectConverter::JsonObjectToUStruct(ImportSettingsJson, GetClass(), this, 0, SkipFlags);
+
 	/*
 	// Skip instanced object references. 
 	int64 SkipFlags = CPF_InstancedReference;
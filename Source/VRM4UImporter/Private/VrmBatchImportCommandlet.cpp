@@ -0,0 +1,465 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmBatchImportCommandlet.h"
+#include "VRM4UImporterLog.h"
+
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/Paths.h"
+#include "Misc/Parse.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Modules/ModuleManager.h"
+#include "Engine/Blueprint.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/UObjectIterator.h"
+#if	UE_VERSION_OLDER_THAN(5,0,0)
+#else
+#include "UObject/SavePackage.h"
+#endif
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+#include "LoaderBPFunctionLibrary.h"
+#include "VrmAssetListObject.h"
+#include "VrmRuntimeSettings.h"
+#include "VrmLoadProfile.h"
+#include "VrmImportUI.h"
+#include "VrmConvert.h"
+
+namespace {
+	// one model. the worker task fills File, ScenePtr and ImageList, then the game thread converts
+	struct FBatchImportJob {
+		FString FilePath;
+		FString PackageName;
+
+		// rooted while the job is alive. option data is owned by this
+		UVrmImportUI* ImportUI = nullptr;
+		VRMConverter::Options LoadOptions;
+		FVrmLoadProfile Profile;
+
+		FVrmMappedFile File;
+		FString ImporterExt;
+		VrmJson Json;
+		Assimp::Importer Importer;
+		const aiScene* ScenePtr = nullptr;
+		TArray<VRMUtil::FImportImage> ImageList;
+
+		FGraphEventRef Task;
+		// read ahead memory until the task is complete
+		int64 EstimateBytes = 0;
+		FString Error;
+		double WorkerSec = 0.0;
+		double ConvertSec = 0.0;
+		double SaveSec = 0.0;
+
+		~FBatchImportJob() {
+			if (ImportUI) {
+				ImportUI->RemoveFromRoot();
+			}
+		}
+	};
+
+	// same defaults as the import dialog, then the preset
+	void SetupImportUI(UVrmImportUI* ImportUI, const FString& FilePath, const TSharedPtr<FJsonObject>& Preset) {
+		ImportUI->bRemoveRootBoneRotation = true;
+		ImportUI->bVrm10RemoveLocalRotation = false;
+		ImportUI->ModelScale = 1.0f;
+		ImportUI->bMergeMaterial = true;
+		ImportUI->bMergePrimitive = false;
+
+		const FString Extension = FPaths::GetExtension(FilePath).ToLower();
+		if (Extension == TEXT("pmx")) {
+			ImportUI->ModelScale = 0.1f;
+			ImportUI->bMergeMaterial = false;
+			ImportUI->bMergePrimitive = false;
+			ImportUI->bForceTwoSided = true;
+		}
+		if (Extension == TEXT("bvh")) {
+			ImportUI->ModelScale = 0.01f;
+		}
+#if	UE_VERSION_OLDER_THAN(5,2,0)
+		ImportUI->bSingleUAssetFile = true;
+#endif
+
+		if (Preset.IsValid()) {
+			ImportUI->ParseFromJson(Preset.ToSharedRef());
+		}
+	}
+
+	// <Dest>/<sub dir>/<name>/<name>. assets of each model are in its own folder
+	// bAddExtension: <name>_<ext>. for the same name with other extension
+	FString GetPackageName(const FString& Dir, const FString& Dest, const FString& FilePath, bool bAddExtension) {
+		FString ret = Dest;
+
+		FString rel = FPaths::GetPath(FilePath);
+		FPaths::MakePathRelativeTo(rel, *(Dir / TEXT("")));
+		TArray<FString> dirList;
+		rel.ParseIntoArray(dirList, TEXT("/"), true);
+		for (const auto& d : dirList) {
+			if (d == TEXT(".") || d == TEXT("..")) {
+				continue;
+			}
+			ret /= VRMConverter::NormalizeFileName(d);
+		}
+
+		FString name = FPaths::GetBaseFilename(FilePath);
+		if (bAddExtension) {
+			name += TEXT("_") + FPaths::GetExtension(FilePath).ToLower();
+		}
+		name = VRMConverter::NormalizeFileName(name);
+		return ret / name / name;
+	}
+
+	// same order as the import factory
+	UClass* GetAssetListClass() {
+		auto getClass = [](const FSoftObjectPath& r) -> UClass* {
+			UBlueprint* bp = Cast<UBlueprint>(r.TryLoad());
+			if (bp && bp->GeneratedClass) {
+				return bp->GeneratedClass;
+			}
+			return nullptr;
+		};
+
+		UClass* c = nullptr;
+		if (VRMConverter::Options::Get().IsUE5Material() == false) {
+			c = getClass(GetDefault<UVrmRuntimeSettings>()->AssetListObject);
+		}
+		if (c == nullptr) {
+			c = getClass(FSoftObjectPath(TEXT("/VRM4U/VrmAssetListObjectBPUE5.VrmAssetListObjectBPUE5")));
+		}
+		if (c == nullptr) {
+			c = getClass(FSoftObjectPath(TEXT("/VRM4U/VrmAssetListObjectBP.VrmAssetListObjectBP")));
+		}
+		if (c == nullptr) {
+			c = UVrmAssetListObject::StaticClass();
+		}
+		return c;
+	}
+
+	// decoded textures are usually a few times larger than the file
+	constexpr int64 ReadAheadExpand = 4;
+
+	// file and decoded images. estimate while the worker is running
+	int64 GetJobBytes(const FBatchImportJob& job) {
+		if (job.Task.IsValid() == false || job.Task->IsComplete() == false) {
+			return job.EstimateBytes;
+		}
+		int64 ret = job.File.Num();
+		for (const auto& img : job.ImageList) {
+			ret += img.RawData.Num();
+		}
+		return ret;
+	}
+
+	// worker thread. no UObject access
+	void ReadJob(FBatchImportJob& job, bool bSkipCompleteAttribute) {
+		VRMConverter::Options::Scope OptionScope(job.LoadOptions);
+		FVrmLoadProfileScope ProfileScope(job.Profile);
+		const double StartTime = FPlatformTime::Seconds();
+
+		if (job.File.Open(job.FilePath) == false || job.File.Num() == 0) {
+			job.Error = TEXT("read failure");
+			return;
+		}
+		job.Profile.FileSizeMB = (float)((double)job.File.Num() / (1024.0 * 1024.0));
+		job.Profile.AddStage(TEXT("ReadFile"), FPlatformTime::Seconds() - StartTime);
+
+		// model type goes to job.LoadOptions
+		job.ImporterExt = ULoaderBPFunctionLibrary::SetVRMModelType(job.FilePath, job.File.GetData(), job.File.Num(), &job.Json);
+		job.ScenePtr = ULoaderBPFunctionLibrary::ReadVRMScene(job.Importer, job.ImporterExt, job.FilePath, job.File.GetData(), job.File.Num(), bSkipCompleteAttribute, &job.Json);
+		if (job.ScenePtr == nullptr) {
+			job.Error = FString(TEXT("assimp: ")) + UTF8_TO_TCHAR(job.Importer.GetErrorString());
+			return;
+		}
+
+		VRMLoaderUtil::DecodeSceneTextures(job.ScenePtr, job.ImageList);
+
+		job.WorkerSec = FPlatformTime::Seconds() - StartTime;
+	}
+
+	// dirty packages of one model. returns the number of failures
+	int32 SaveModelPackages(const TArray<UPackage*>& PackageList) {
+		int32 failNum = 0;
+		for (UPackage* pkg : PackageList) {
+			if (pkg->IsDirty() == false) {
+				continue;
+			}
+			const FString file = FPackageName::LongPackageNameToFilename(pkg->GetName(), FPackageName::GetAssetPackageExtension());
+#if	UE_VERSION_OLDER_THAN(5,0,0)
+			const bool bSaved = UPackage::SavePackage(pkg, nullptr, RF_Standalone, *file, GError, nullptr, false, true, SAVE_NoError);
+#else
+			FSavePackageArgs SaveArgs;
+			SaveArgs.TopLevelFlags = RF_Standalone;
+			SaveArgs.SaveFlags = SAVE_NoError;
+			SaveArgs.Error = GError;
+			const bool bSaved = UPackage::SavePackage(pkg, nullptr, *file, SaveArgs);
+#endif
+			if (bSaved == false) {
+				UE_LOG(LogVRM4UImporter, Error, TEXT("VrmBatchImport: failed to save %s"), *file);
+				++failNum;
+			}
+		}
+		return failNum;
+	}
+
+	// game thread. asset creation and save
+	bool ConvertJob(FBatchImportJob& job) {
+		VRMConverter::Options::Scope OptionScope(job.LoadOptions);
+		FVrmLoadProfileScope ProfileScope(job.Profile);
+
+		double StartTime = FPlatformTime::Seconds();
+
+#if	UE_VERSION_OLDER_THAN(4,26,0)
+		UPackage* pkg = CreatePackage(nullptr, *job.PackageName);
+#else
+		UPackage* pkg = CreatePackage(*job.PackageName);
+#endif
+		UVrmAssetListObject* InAsset = NewObject<UVrmAssetListObject>((UObject*)GetTransientPackage(), GetAssetListClass());
+		UVrmAssetListObject* OutAsset = nullptr;
+
+		ULoaderBPFunctionLibrary::SetImportMode(true, pkg);
+		bool ret = ULoaderBPFunctionLibrary::LoadVRMFileFromScene(InAsset, OutAsset, job.FilePath, job.File.GetData(), job.File.Num(), job.ScenePtr, &job.ImageList, &job.Json);
+		ULoaderBPFunctionLibrary::SetImportMode(false, nullptr);
+		if (ret == false) {
+			job.Error = TEXT("convert failure");
+		}
+		job.ConvertSec = FPlatformTime::Seconds() - StartTime;
+		StartTime = FPlatformTime::Seconds();
+
+		// sub packages are created next to the model package
+		const FString prefix = FPackageName::GetLongPackagePath(job.PackageName) + TEXT("/");
+		TArray<UPackage*> packageList;
+		for (TObjectIterator<UPackage> it; it; ++it) {
+			if (it->GetName().StartsWith(prefix)) {
+				packageList.Add(*it);
+			}
+		}
+		if (ret) {
+			if (SaveModelPackages(packageList)) {
+				job.Error = TEXT("save failure");
+				ret = false;
+			}
+		}
+		job.SaveSec = FPlatformTime::Seconds() - StartTime;
+		FVrmLoadProfileScope::AddStage(TEXT("Save"), job.SaveSec);
+		job.Profile.End(ret ? OutAsset : nullptr, ret);
+
+		// saved. the next GC releases them
+		for (UPackage* p : packageList) {
+			TArray<UObject*> objList;
+			GetObjectsWithOuter(p, objList, true);
+			for (UObject* o : objList) {
+				o->ClearFlags(RF_Standalone);
+			}
+		}
+		return ret;
+	}
+}
+
+UVrmBatchImportCommandlet::UVrmBatchImportCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UVrmBatchImportCommandlet::Main(const FString& Params)
+{
+	FString Dir;
+	FString Dest = TEXT("/Game/VRM");
+	FString PresetFile;
+	FString Out = FPaths::ProjectSavedDir() / TEXT("VRM4U") / TEXT("BatchImport.csv");
+	int32 JobNum = FTaskGraphInterface::Get().GetNumWorkerThreads();
+	int32 MaxReadAheadMB = 2048;
+
+	if (FParse::Value(*Params, TEXT("Dir="), Dir) == false) {
+		UE_LOG(LogVRM4UImporter, Error, TEXT("VrmBatchImport: -Dir=<model dir> is required"));
+		return 1;
+	}
+	FParse::Value(*Params, TEXT("Dest="), Dest);
+	FParse::Value(*Params, TEXT("Preset="), PresetFile);
+	FParse::Value(*Params, TEXT("Out="), Out);
+	FParse::Value(*Params, TEXT("Jobs="), JobNum);
+	JobNum = FMath::Max(JobNum, 1);
+	FParse::Value(*Params, TEXT("MaxReadAheadMB="), MaxReadAheadMB);
+	MaxReadAheadMB = FMath::Max(MaxReadAheadMB, 1);
+	const int64 MaxReadAheadBytes = (int64)MaxReadAheadMB * 1024 * 1024;
+
+	const bool bRecursive = FParse::Param(*Params, TEXT("Recursive"));
+
+	Dest.RemoveFromEnd(TEXT("/"));
+	if (FPackageName::IsValidLongPackageName(Dest) == false) {
+		UE_LOG(LogVRM4UImporter, Error, TEXT("VrmBatchImport: invalid -Dest=%s"), *Dest);
+		return 1;
+	}
+
+	TSharedPtr<FJsonObject> Preset;
+	if (PresetFile.Len()) {
+		FString text;
+		if (FFileHelper::LoadFileToString(text, *PresetFile) == false) {
+			UE_LOG(LogVRM4UImporter, Error, TEXT("VrmBatchImport: failed to read %s"), *PresetFile);
+			return 1;
+		}
+		TSharedRef<TJsonReader<>> reader = TJsonReaderFactory<>::Create(text);
+		if (FJsonSerializer::Deserialize(reader, Preset) == false || Preset.IsValid() == false) {
+			UE_LOG(LogVRM4UImporter, Error, TEXT("VrmBatchImport: invalid preset %s"), *PresetFile);
+			return 1;
+		}
+	}
+
+	TArray<FString> fileList;
+	for (const TCHAR* ext : { TEXT("*.vrm"), TEXT("*.vrma"), TEXT("*.glb"), TEXT("*.pmx"), TEXT("*.bvh") }) {
+		TArray<FString> f;
+		if (bRecursive) {
+			IFileManager::Get().FindFilesRecursive(f, *Dir, ext, true, false);
+		} else {
+			IFileManager::Get().FindFiles(f, *(Dir / ext), true, false);
+			for (auto& s : f) {
+				s = Dir / s;
+			}
+		}
+		fileList.Append(f);
+	}
+	fileList.Sort();
+
+	if (fileList.Num() == 0) {
+		UE_LOG(LogVRM4UImporter, Warning, TEXT("VrmBatchImport: no model in %s"), *Dir);
+		return 1;
+	}
+
+	// a.vrm and a.glb get the extension in the name. other collisions (normalized names) are not imported
+	TArray<FString> packageNameList;
+	TSet<FString> collisionSet;
+	{
+		TMap<FString, int32> nameCount;
+		for (const auto& f : fileList) {
+			++nameCount.FindOrAdd(GetPackageName(Dir, Dest, f, false));
+		}
+		for (const auto& f : fileList) {
+			const FString name = GetPackageName(Dir, Dest, f, false);
+			packageNameList.Add(nameCount[name] > 1 ? GetPackageName(Dir, Dest, f, true) : name);
+		}
+
+		TSet<FString> nameSet;
+		for (const auto& name : packageNameList) {
+			bool bAlready = false;
+			nameSet.Add(name, &bAlready);
+			if (bAlready) {
+				collisionSet.Add(name);
+			}
+		}
+	}
+
+	// module load is game thread only
+	FModuleManager::Get().LoadModule(TEXT("ImageWrapper"));
+
+	TArray<TUniquePtr<FBatchImportJob>> jobList;
+	jobList.SetNum(fileList.Num());
+
+	auto dispatch = [&](int32 fileNo) {
+		TUniquePtr<FBatchImportJob> job = MakeUnique<FBatchImportJob>();
+		job->FilePath = fileList[fileNo];
+		job->PackageName = packageNameList[fileNo];
+		if (collisionSet.Contains(job->PackageName)) {
+			job->Error = TEXT("package name collision");
+			job->Profile.Begin(job->FilePath);
+			jobList[fileNo] = MoveTemp(job);
+			return;
+		}
+
+		job->ImportUI = NewObject<UVrmImportUI>(GetTransientPackage(), NAME_None, RF_NoFlags);
+		job->ImportUI->AddToRoot();
+		SetupImportUI(job->ImportUI, job->FilePath, Preset);
+
+		// copy current settings (material type etc), then bind to the option of this file
+		job->LoadOptions = VRMConverter::Options::Get();
+		job->LoadOptions.SetVrmOption(job->ImportUI->GenerateOptionData());
+		job->Profile.Begin(job->FilePath);
+		job->EstimateBytes = FMath::Max<int64>(IFileManager::Get().FileSize(*job->FilePath), 0) * ReadAheadExpand;
+
+		FBatchImportJob* p = job.Get();
+		const bool bSkipCompleteAttribute = job->LoadOptions.IsSkipCompleteAttributeGeneration();
+		TFunction< void() > f = [p, bSkipCompleteAttribute] {
+			ReadJob(*p, bSkipCompleteAttribute);
+		};
+		job->Task = FFunctionGraphTask::CreateAndDispatchWhenReady(f, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+		jobList[fileNo] = MoveTemp(job);
+	};
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	// up to JobNum files are read ahead of the one being converted, within MaxReadAheadBytes.
+	// the file being converted is always dispatched
+	int32 nextNo = 0;
+	auto fillReadAhead = [&](int32 fileNo) {
+		while (nextNo < fileList.Num() && nextNo - fileNo <= JobNum) {
+			if (nextNo > fileNo) {
+				int64 bytes = FMath::Max<int64>(IFileManager::Get().FileSize(*fileList[nextNo]), 0) * ReadAheadExpand;
+				for (int32 i = fileNo; i < nextNo; ++i) {
+					bytes += GetJobBytes(*jobList[i]);
+				}
+				if (bytes > MaxReadAheadBytes) {
+					break;
+				}
+			}
+			dispatch(nextNo++);
+		}
+	};
+
+	TArray<FString> lines;
+	lines.Add(FVrmLoadProfile::GetCSVHeader() + TEXT(",Package,WorkerMs,Error"));
+
+	TArray<FString> failList;
+	for (int32 fileNo = 0; fileNo < fileList.Num(); ++fileNo) {
+		fillReadAhead(fileNo);
+
+		FBatchImportJob& job = *jobList[fileNo];
+		if (job.Task.IsValid()) {
+			FTaskGraphInterface::Get().WaitUntilTaskCompletes(job.Task);
+		}
+
+		// the current job is measured now. more files may fit while it is converted
+		fillReadAhead(fileNo);
+
+		bool b = false;
+		if (job.Error.IsEmpty()) {
+			b = ConvertJob(job);
+		} else {
+			job.Profile.End(nullptr, false);
+		}
+
+		if (b) {
+			UE_LOG(LogVRM4UImporter, Display, TEXT("VrmBatchImport: [%d/%d] %s -> %s  read/parse/decode %.1f ms  convert %.1f ms  save %.1f ms"),
+				fileNo + 1, fileList.Num(), *job.FilePath, *job.PackageName, job.WorkerSec * 1000.0, job.ConvertSec * 1000.0, job.SaveSec * 1000.0);
+		} else {
+			UE_LOG(LogVRM4UImporter, Error, TEXT("VrmBatchImport: [%d/%d] %s (%s)"), fileNo + 1, fileList.Num(), *job.FilePath, *job.Error);
+			failList.Add(job.FilePath + TEXT(" : ") + job.Error);
+		}
+		lines.Add(job.Profile.ToCSV() + FString::Printf(TEXT(",\"%s\",%.2f,\"%s\""), *job.PackageName, job.WorkerSec * 1000.0, *job.Error.Replace(TEXT("\""), TEXT("\"\""))));
+
+		// scene, file and images of this model
+		jobList[fileNo].Reset();
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	const double TotalSec = FPlatformTime::Seconds() - StartTime;
+
+	if (FFileHelper::SaveStringArrayToFile(lines, *Out) == false) {
+		UE_LOG(LogVRM4UImporter, Error, TEXT("VrmBatchImport: failed to write %s"), *Out);
+	}
+
+	for (const auto& s : failList) {
+		UE_LOG(LogVRM4UImporter, Error, TEXT("VrmBatchImport: failed %s"), *s);
+	}
+	UE_LOG(LogVRM4UImporter, Display, TEXT("VrmBatchImport: %d file(s), %d failure(s), %.1f sec, %d job(s), %d MB read ahead -> %s"), fileList.Num(), failList.Num(), TotalSec, JobNum, MaxReadAheadMB, *Out);
+
+	return failList.Num() ? 1 : 0;
+}
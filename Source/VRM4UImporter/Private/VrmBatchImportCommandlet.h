@@ -0,0 +1,25 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "VrmBatchImportCommandlet.generated.h"
+
+/**
+ * Imports every model in a directory into content packages without the option dialog.
+ * File read, assimp parse and texture decode run on worker threads. Asset creation and save run on the game thread, one file at a time.
+ *
+ * -run=VrmBatchImport -Dir=<model dir> [-Dest=/Game/VRM] [-Preset=<json>] [-Out=<csv>] [-Jobs=<n>] [-MaxReadAheadMB=<mb>] [-Recursive]
+ *
+ * Jobs is the number of files read ahead. MaxReadAheadMB caps the memory of them (file and decoded textures, default 2048).
+ *
+ * Preset is a json object of UVrmImportUI property names. ex) { "ModelScale": 1.0, "bMergeMaterial": false }
+ */
+UCLASS()
+class UVrmBatchImportCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	virtual int32 Main(const FString& Params) override;
+};
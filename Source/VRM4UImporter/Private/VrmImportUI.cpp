@@ -80,8 +80,14 @@ const FImportOptionData* UVrmImportUI::GenerateOptionData() {
 	c(bOptimizeVertex);
 
 	c(bRemoveDegenerateTriangles);
+	c(bOptimizeVertexCache);
+	c(bOptimizeOverdraw);
+
+	c(bSkipCompleteAttributeGeneration);
 
 	c(BoneWeightInfluenceNum);
+	c(BoneWeightPruneThreshold);
+	c(bBoneWeight8Bit);
 
 	c(bSimpleRoot);
 
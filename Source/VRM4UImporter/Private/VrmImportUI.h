@@ -168,10 +168,30 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = Mesh, meta = (ImportType = "StaticMesh|SkeletalMesh", DisplayName = "[Optimize] remove degenerate triangles"))
 	bool bRemoveDegenerateTriangles = false;
 
+	/** Reorder triangles and vertices of each section for the GPU vertex cache */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = Mesh, meta = (ImportType = "StaticMesh|SkeletalMesh", DisplayName = "[Optimize] vertex cache order"))
+	bool bOptimizeVertexCache = false;
+
+	/** With vertex cache order. Draw outward facing triangles first to reduce overdraw */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = Mesh, meta = (ImportType = "StaticMesh|SkeletalMesh", DisplayName = "[Optimize] overdraw order", EditCondition = "bOptimizeVertexCache"))
+	bool bOptimizeOverdraw = false;
+
+	/** Skip normal/tangent generation when all glTF primitives have them */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = Mesh, meta = (ImportType = "StaticMesh|SkeletalMesh", DisplayName = "[Optimize] Skip normal/tangent generation"))
+	bool bSkipCompleteAttributeGeneration = true;
+
 	/** BoneWeight influence */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = Mesh, meta = (ImportType = "StaticMesh|SkeletalMesh", DisplayName = "[Optimize] Bone Weight Influence Num"))
 	int BoneWeightInfluenceNum = 8;
 
+	/** Normalized bone weights below this are removed */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = Mesh, meta = (ImportType = "StaticMesh|SkeletalMesh", DisplayName = "[Optimize] Bone Weight Prune Threshold", ClampMin = 0, ClampMax = 0.5))
+	float BoneWeightPruneThreshold = 0.f;
+
+	/** Quantize bone weights to 8 bit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = Mesh, meta = (ImportType = "StaticMesh|SkeletalMesh", DisplayName = "[Optimize] 8 bit Bone Weight"))
+	bool bBoneWeight8Bit = false;
+
 	/** Remove bone has no mesh */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, AdvancedDisplay, Category = Mesh, meta = (ImportType = "StaticMesh|SkeletalMesh", DisplayName = "[Optimize] Remove bone used DCC tool"))
 	bool bSimpleRoot = true;
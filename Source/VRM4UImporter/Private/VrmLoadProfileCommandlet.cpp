@@ -0,0 +1,115 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmLoadProfileCommandlet.h"
+#include "VRM4UImporterLog.h"
+
+#include "Misc/EngineVersionComparison.h"
+#include "Misc/Paths.h"
+#include "Misc/Parse.h"
+#include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
+#include "Engine/Blueprint.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+
+#include "LoaderBPFunctionLibrary.h"
+#include "VrmAssetListObject.h"
+#include "VrmLoadProfile.h"
+
+namespace {
+	UClass* GetAssetListClass() {
+		const TCHAR* pathList[] = {
+			TEXT("/VRM4U/VrmAssetListObjectBPUE5.VrmAssetListObjectBPUE5"),
+			TEXT("/VRM4U/VrmAssetListObjectBP.VrmAssetListObjectBP"),
+		};
+		for (const TCHAR* path : pathList) {
+			FSoftObjectPath r(path);
+			UBlueprint* bp = Cast<UBlueprint>(r.TryLoad());
+			if (bp && bp->GeneratedClass) {
+				return bp->GeneratedClass;
+			}
+		}
+		return UVrmAssetListObject::StaticClass();
+	}
+}
+
+UVrmLoadProfileCommandlet::UVrmLoadProfileCommandlet(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UVrmLoadProfileCommandlet::Main(const FString& Params)
+{
+	FString Dir;
+	FString Out = FPaths::ProjectSavedDir() / TEXT("VRM4U") / TEXT("LoadProfile.csv");
+	int32 Repeat = 1;
+
+	if (FParse::Value(*Params, TEXT("Dir="), Dir) == false) {
+		UE_LOG(LogVRM4UImporter, Error, TEXT("VrmLoadProfile: -Dir=<model dir> is required"));
+		return 1;
+	}
+	FParse::Value(*Params, TEXT("Out="), Out);
+	FParse::Value(*Params, TEXT("Repeat="), Repeat);
+	Repeat = FMath::Max(Repeat, 1);
+
+	const bool bRecursive = FParse::Param(*Params, TEXT("Recursive"));
+
+	FImportOptionData Option;
+	Option.bUseLoadCache = FParse::Param(*Params, TEXT("Cache"));
+
+	TArray<FString> fileList;
+	for (const TCHAR* ext : { TEXT("*.vrm"), TEXT("*.glb"), TEXT("*.pmx") }) {
+		TArray<FString> f;
+		if (bRecursive) {
+			IFileManager::Get().FindFilesRecursive(f, *Dir, ext, true, false);
+		} else {
+			IFileManager::Get().FindFiles(f, *(Dir / ext), true, false);
+			for (auto& s : f) {
+				s = Dir / s;
+			}
+		}
+		fileList.Append(f);
+	}
+	fileList.Sort();
+
+	if (fileList.Num() == 0) {
+		UE_LOG(LogVRM4UImporter, Warning, TEXT("VrmLoadProfile: no model in %s"), *Dir);
+		return 1;
+	}
+
+	UClass* c = GetAssetListClass();
+
+	TArray<FString> lines;
+	lines.Add(FVrmLoadProfile::GetCSVHeader());
+
+	int32 failNum = 0;
+	for (const auto& file : fileList) {
+		for (int32 i = 0; i < Repeat; ++i) {
+			UVrmAssetListObject* InAsset = NewObject<UVrmAssetListObject>((UObject*)GetTransientPackage(), c);
+			UVrmAssetListObject* OutAsset = nullptr;
+			FVrmLoadProfile Profile;
+
+			const bool b = ULoaderBPFunctionLibrary::LoadVRMFileWithProfile(InAsset, OutAsset, file, Option, Profile);
+			if (b == false) {
+				++failNum;
+			}
+			lines.Add(Profile.ToCSV());
+			UE_LOG(LogVRM4UImporter, Display, TEXT("VrmLoadProfile: %s %.1f ms %s"), *file, Profile.TotalMs, b ? TEXT("") : TEXT("(failed)"));
+
+			// next load starts from a clean state
+			CollectGarbage(RF_NoFlags);
+		}
+	}
+
+	if (FFileHelper::SaveStringArrayToFile(lines, *Out) == false) {
+		UE_LOG(LogVRM4UImporter, Error, TEXT("VrmLoadProfile: failed to write %s"), *Out);
+		return 1;
+	}
+	UE_LOG(LogVRM4UImporter, Display, TEXT("VrmLoadProfile: %d file(s), %d failure(s) -> %s"), fileList.Num(), failNum, *Out);
+
+	return failNum ? 1 : 0;
+}
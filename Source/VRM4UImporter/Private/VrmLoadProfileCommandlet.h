@@ -0,0 +1,20 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "VrmLoadProfileCommandlet.generated.h"
+
+/**
+ * Runtime-loads every model in a directory and writes the load profile as CSV.
+ *
+ * -run=VrmLoadProfile -Dir=<model dir> [-Out=<csv>] [-Repeat=<n>] [-Recursive] [-Cache]
+ */
+UCLASS()
+class UVrmLoadProfileCommandlet : public UCommandlet
+{
+	GENERATED_UCLASS_BODY()
+
+	virtual int32 Main(const FString& Params) override;
+};
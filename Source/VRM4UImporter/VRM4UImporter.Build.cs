@@ -30,6 +30,9 @@ public class VRM4UImporter : ModuleRules
 				"Persona",
 				"MainFrame",
 
+				"Json",
+				"JsonUtilities",
+
 				//"ToolMenus",
 			});
 
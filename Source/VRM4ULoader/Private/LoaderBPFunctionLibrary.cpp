@@ -11,6 +11,8 @@
 #include "Vrm1LicenseObject.h"
 
 #include "VrmAsyncLoadAction.h"
+#include "VrmLoadCache.h"
+#include "VrmSharedAssetRegistry.h"
 
 #include "VrmConvert.h"
 #include "VrmUtil.h"
@@ -33,6 +35,8 @@
 #include "PhysicsEngine/PhysicsConstraintTemplate.h"
 #include "Misc/FeedbackContext.h"
 #include "Misc/FileHelper.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
 #include "UObject/Package.h"
 #include "Engine/SkeletalMeshSocket.h"
 #include "EditorFramework/AssetImportData.h"
@@ -128,7 +132,6 @@
 // tem
 namespace {
 	UPackage *s_vrm_package = nullptr;
-	FString baseFileName;
 }
 
 namespace {
@@ -160,16 +163,22 @@ namespace {
 }
 
 
-static std::string GetExtAndSetModelTypeLocal(std::string e, const uint8* pDataLocal, size_t sizeLocal) {
+static std::string GetExtAndSetModelTypeLocal(std::string e, const uint8* pDataLocal, size_t sizeLocal, VrmJson* OutJson = nullptr) {
 	std::string e_tmp = e;
 	VRMConverter::Options::Get().ClearModelType();
 
+	// json is parsed once here and reused by the caller
+	VrmJson localJson;
+	VrmJson& json = OutJson ? *OutJson : localJson;
+	if (e.compare("vrm") == 0 || e.compare("glb") == 0 || e.compare("gltf") == 0 || e.compare("vrma") == 0) {
+		json.init(pDataLocal, sizeLocal);
+	}
+
 	if (e.compare("vrm") == 0 || e.compare("glb") == 0 || e.compare("gltf") == 0) {
 
 		VRMConverter::Options::Get().SetVRM0Model(true);
 
-		extern bool VRMIsVRM10(const uint8 * pData, size_t size);
-		if (VRMIsVRM10(pDataLocal, sizeLocal)) {
+		if (json.IsEnable() && json.IsVRM10()) {
 			VRMConverter::Options::Get().SetVRM10Model(true);
 		}
 	}
@@ -521,10 +530,92 @@ namespace {
 #endif
 }
 
+namespace {
+	// read GLB header and JSON chunk only. thumbnail image is read from BIN chunk with seek
+	bool LocalGetVRMMetaFromHeader(const FString& filepath, UVrmLicenseObject*& a, UVrm1LicenseObject*& b) {
+		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("GetVRMMeta header"))
+
+		TUniquePtr<IFileHandle> h(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*filepath));
+		if (h.IsValid() == false) {
+			return false;
+		}
+		const int64 fileSize = h->Size();
+
+		// magic, version, length, chunk0 length, chunk0 type
+		uint8 head[20] = {};
+		if (fileSize < (int64)sizeof(head) || h->Read(head, sizeof(head)) == false) {
+			return false;
+		}
+		if (FMemory::Memcmp(head, "glTF", 4) != 0 || FMemory::Memcmp(head + 16, "JSON", 4) != 0) {
+			return false;
+		}
+		uint32 jsonSize = 0;
+		FMemory::Memcpy(&jsonSize, head + 12, sizeof(jsonSize));
+		if (jsonSize == 0 || (int64)sizeof(head) + jsonSize > fileSize) {
+			return false;
+		}
+
+		TArray<uint8> json;
+		json.SetNumUninitialized(jsonSize);
+		if (h->Read(json.GetData(), jsonSize) == false) {
+			return false;
+		}
+
+		VRMConverter vc;
+		if (vc.jsonData.initJson((const char*)json.GetData(), json.Num()) == false) {
+			return false;
+		}
+
+		int imageIndex = -1;
+		UVrmLicenseObject* m = nullptr;
+		UVrm1LicenseObject* m1 = nullptr;
+		if (vc.GetVRMMetaFromJson(m, m1, imageIndex) == false) {
+			return false;
+		}
+
+		UTexture2D* NewTexture2D = nullptr;
+		size_t offset = 0;
+		size_t length = 0;
+		if (vc.jsonData.GetImageBufferView(imageIndex, offset, length)) {
+			// second chunk. length, type. must be BIN
+			uint8 binHead[8] = {};
+			uint32 binSize = 0;
+			uint32 binType = 0;
+			const int64 binStart = (int64)sizeof(head) + jsonSize + sizeof(binHead);
+			if (binStart <= fileSize && h->Seek((int64)sizeof(head) + jsonSize) && h->Read(binHead, sizeof(binHead))) {
+				FMemory::Memcpy(&binSize, binHead, sizeof(binSize));
+				FMemory::Memcpy(&binType, binHead + 4, sizeof(binType));
+			}
+			if (binType == 0x004E4942 && (int64)(offset + length) <= (int64)binSize && binStart + (int64)binSize <= fileSize) {
+				TArray<uint8> img;
+				img.SetNumUninitialized(length);
+				if (h->Seek(binStart + offset) && h->Read(img.GetData(), length)) {
+					NewTexture2D = VRMLoaderUtil::CreateTextureFromImage(TEXT("T_thumbnail"), GetTransientPackage(), img.GetData(), img.Num());
+					if (NewTexture2D && VRMConverter::IsImportMode() == false) {
+						NewTexture2D->UpdateResource();
+					}
+				}
+			}
+		}
+
+		if (m) m->thumbnail = NewTexture2D;
+		if (m1) m1->thumbnail = NewTexture2D;
+
+		a = m;
+		b = m1;
+		return true;
+	}
+}
+
 void ULoaderBPFunctionLibrary::GetVRMMeta(FString filepath, UVrmLicenseObject*& a, UVrm1LicenseObject*& b) {
 
 	UE_LOG(LogVRM4ULoader, Log, TEXT("GetVRMMeta:OrigFileName=%s"), *filepath);
 
+	// fast path. vrm/glb
+	if (LocalGetVRMMetaFromHeader(filepath, a, b)) {
+		return;
+	}
+
 	std::string file;
 #if PLATFORM_WINDOWS
 	file = utf_16_to_shift_jis(*filepath);
@@ -540,10 +631,10 @@ void ULoaderBPFunctionLibrary::GetVRMMeta(FString filepath, UVrmLicenseObject*&
 
 	VRMConverter vc;
 	{
-		TArray<uint8> Res;
-		if (FFileHelper::LoadFileToArray(Res, *filepath)) {
+		FVrmMappedFile Res;
+		if (Res.Open(filepath)) {
 		}
-		UE_LOG(LogVRM4ULoader, Log, TEXT("GetVRMMeta: filesize=%d"), Res.Num());
+		UE_LOG(LogVRM4ULoader, Log, TEXT("GetVRMMeta: filesize=%lld mapped=%d"), Res.Num(), Res.IsMapped() ? 1 : 0);
 
 		const FString ext = FPaths::GetExtension(filepath);
 #if PLATFORM_WINDOWS
@@ -552,7 +643,8 @@ void ULoaderBPFunctionLibrary::GetVRMMeta(FString filepath, UVrmLicenseObject*&
 		std::string e = TCHAR_TO_UTF8(*ext);
 #endif
 
-		e = GetExtAndSetModelTypeLocal(e, Res.GetData(), Res.Num());
+		VrmJson json;
+		e = GetExtAndSetModelTypeLocal(e, Res.GetData(), Res.Num(), &json);
 
 		mScenePtr = mImporter.ReadFileFromMemory(Res.GetData(), Res.Num(),
 			aiProcess_Triangulate | aiProcess_MakeLeftHanded | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals | aiProcess_OptimizeMeshes,
@@ -569,11 +661,9 @@ void ULoaderBPFunctionLibrary::GetVRMMeta(FString filepath, UVrmLicenseObject*&
 
 		{
 			// vrm version check
-
-			extern bool VRMIsVRM10(const uint8 * pData, size_t size);
-			if (VRMIsVRM10(Res.GetData(), Res.Num())) {
+			vc.Init(Res.GetData(), Res.Num(), nullptr, &json);
+			if (vc.jsonData.IsVRM10()) {
 				VRMConverter::Options::Get().SetVRM10Model(true);
-				vc.Init(Res.GetData(), Res.Num(), nullptr);
 			}
 		}
 	}
@@ -620,15 +710,49 @@ bool ULoaderBPFunctionLibrary::VRMSetLoadMaterialType(EVRMImportMaterialType typ
 	return true;
 }
 
+void ULoaderBPFunctionLibrary::VRMClearLoadCache() {
+	FVrmLoadCache::Clear();
+}
+
+void ULoaderBPFunctionLibrary::VRMSetLoadCacheMaxSize(int32 MaxSizeMB) {
+	FVrmLoadCache::SetMaxSize((int64)FMath::Max(MaxSizeMB, 0) * 1024 * 1024);
+}
+
+bool ULoaderBPFunctionLibrary::VRMReleaseSharedAsset(const UVrmAssetListObject* VrmAsset) {
+	return FVrmSharedAssetRegistry::Get().Release(VrmAsset);
+}
+
+void ULoaderBPFunctionLibrary::VRMClearSharedAsset() {
+	FVrmSharedAssetRegistry::Get().Clear();
+}
+
 bool ULoaderBPFunctionLibrary::LoadVRMFile(const UVrmAssetListObject *InVrmAsset, UVrmAssetListObject *&OutVrmAsset, const FString filepath, const FImportOptionData &OptionForRuntimeLoad) {
+	FVrmLoadProfile Profile;
+	return LoadVRMFileWithProfile(InVrmAsset, OutVrmAsset, filepath, OptionForRuntimeLoad, Profile);
+}
+
+bool ULoaderBPFunctionLibrary::LoadVRMFileWithProfile(const UVrmAssetListObject* InVrmAsset, UVrmAssetListObject*& OutVrmAsset, const FString filepath, const FImportOptionData& OptionForRuntimeLoad, FVrmLoadProfile& OutProfile) {
 	VRMConverter::Options::Get().SetVrmOption(&OptionForRuntimeLoad);
 	OutVrmAsset = nullptr;
 
-	return LoadVRMFileLocal(InVrmAsset, OutVrmAsset, filepath);
+	OutProfile.Begin(filepath);
+	bool ret = false;
+	{
+		FVrmLoadProfileScope ProfileScope(OutProfile);
+		ret = LoadVRMFileLocal(InVrmAsset, OutVrmAsset, filepath);
+	}
+	OutProfile.End(OutVrmAsset, ret);
+	FVrmLoadProfile::SetLastProfile(OutProfile);
+
+	return ret;
+}
+
+void ULoaderBPFunctionLibrary::GetLastVRMLoadProfile(FVrmLoadProfile& OutProfile) {
+	OutProfile = FVrmLoadProfile::GetLastProfile();
 }
 
 void ULoaderBPFunctionLibrary::LoadVRMFileAsync(const UObject* WorldContextObject, const class UVrmAssetListObject* InVrmAsset, class UVrmAssetListObject*& OutVrmAsset, const FString filepath, const FImportOptionData& OptionForRuntimeLoad, struct FLatentActionInfo LatentInfo) {
-	VRMConverter::Options::Get().SetVrmOption(&OptionForRuntimeLoad);
+	// option is copied to the action. each load has its own VRMConverter::Options
 	OutVrmAsset = nullptr;
 
 	if (UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::LogAndReturnNull))
@@ -645,11 +769,36 @@ void ULoaderBPFunctionLibrary::LoadVRMFileAsync(const UObject* WorldContextObjec
 
 
 bool ULoaderBPFunctionLibrary::LoadVRMFileLocal(const UVrmAssetListObject* InVrmAsset, UVrmAssetListObject*& OutVrmAsset, const FString filepath) {
-	TArray<uint8> Res;
-	if (FFileHelper::LoadFileToArray(Res, *filepath)) {
+	// mapped file. no copy of the whole model
+	const double StartTime = FPlatformTime::Seconds();
+	FVrmMappedFile Res;
+	if (Res.Open(filepath)) {
+	}
+	if (FVrmLoadProfile* p = FVrmLoadProfileScope::Get()) {
+		p->FileSizeMB = (float)((double)Res.Num() / (1024.0 * 1024.0));
+		p->AddStage(TEXT("ReadFile"), FPlatformTime::Seconds() - StartTime);
+	}
+
+	// same file and options. return the converted one
+	uint64 shareKey = 0;
+	if (VRMConverter::Options::Get().IsRuntimeShareAsset()) {
+		const FString keyText = FVrmSharedAssetRegistry::GetOptionKeyText(VRMConverter::Options::Get().ImportOption, InVrmAsset);
+		shareKey = FVrmSharedAssetRegistry::MakeKey(Res.GetData(), Res.Num(), keyText);
+		if (UVrmAssetListObject* shared = FVrmSharedAssetRegistry::Get().Acquire(shareKey)) {
+			OutVrmAsset = shared;
+			if (FVrmLoadProfile* p = FVrmLoadProfileScope::Get()) {
+				p->bSharedAsset = true;
+			}
+			return true;
+		}
 	}
 
-	return LoadVRMFileFromMemory(InVrmAsset, OutVrmAsset, filepath, Res.GetData(), Res.Num());
+	const bool ret = LoadVRMFileFromMemory(InVrmAsset, OutVrmAsset, filepath, Res.GetData(), Res.Num());
+	if (ret && shareKey) {
+		// the live one wins if the same model was converted meanwhile
+		OutVrmAsset = FVrmSharedAssetRegistry::Get().Register(shareKey, OutVrmAsset);
+	}
+	return ret;
 }
 
 bool ULoaderBPFunctionLibrary::LoadVRMFileFromMemoryDefaultOption(UVrmAssetListObject*& OutVrmAsset, const FString filepath, const uint8* pData, size_t dataSize) {
@@ -678,62 +827,99 @@ bool ULoaderBPFunctionLibrary::LoadVRMFileFromMemoryDefaultOption(UVrmAssetListO
 	return LoadVRMFileFromMemory(m.Get(), OutVrmAsset, filepath, pData, dataSize);
 }
 
+FString ULoaderBPFunctionLibrary::SetVRMModelType(const FString filepath, const uint8* pFileData, size_t dataSize, VrmJson* OutJson) {
+	VRMConverter::Options::Get().SetVRM0Model(true);
+
+	const FString ext = FPaths::GetExtension(filepath).ToLower();
+#if PLATFORM_WINDOWS
+	std::string e = utf_16_to_shift_jis(*ext);
+#else
+	std::string e = TCHAR_TO_UTF8(*ext);
+#endif
+
+	return UTF8_TO_TCHAR(GetExtAndSetModelTypeLocal(e, pFileData, dataSize, OutJson).c_str());
+}
+
+const aiScene* ULoaderBPFunctionLibrary::ReadVRMScene(Assimp::Importer& Importer, const FString ImporterExt, const FString filepath, const uint8* pFileData, size_t dataSize, bool bSkipCompleteAttribute, const VrmJson* Json) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("AssImpLoader"))
+
+	const double StartTime = FPlatformTime::Seconds();
+	unsigned int flag = aiProcess_Triangulate | aiProcess_MakeLeftHanded | aiProcess_OptimizeMeshes | aiProcess_PopulateArmatureData;
+	{
+		unsigned int attributeFlag = aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals;
+
+		// spatial sort for normal/tangent is heavy on large meshes. skip it if glTF already has them
+		if (bSkipCompleteAttribute && (ImporterExt == TEXT("vrm") || ImporterExt == TEXT("glb") || ImporterExt == TEXT("gltf"))) {
+			if (Json && Json->IsEnable()) {
+				const bool bNormal = Json->HasPrimitiveAttribute("NORMAL");
+				const bool bTangent = bNormal && Json->HasPrimitiveAttribute("TANGENT");
+				if (bNormal) {
+					attributeFlag &= ~aiProcess_GenSmoothNormals;
+				}
+				if (bTangent) {
+					attributeFlag &= ~aiProcess_CalcTangentSpace;
+				}
+				UE_LOG(LogVRM4ULoader, Log, TEXT("VRM: normal=%d tangent=%d (generate only missing attribute)"), bNormal ? 1 : 0, bTangent ? 1 : 0);
+			}
+		}
+		flag |= attributeFlag;
+	}
+
+	Importer.SetPropertyBool(AI_CONFIG_IMPORT_REMOVE_EMPTY_BONES, false);
+
+	const aiScene* mScenePtr = Importer.ReadFileFromMemory(pFileData, dataSize, flag, TCHAR_TO_UTF8(*ImporterExt));
+
+	if (mScenePtr == nullptr) {
+		std::string file;
+#if PLATFORM_WINDOWS
+		file = utf_16_to_shift_jis(*filepath);
+#else
+		file = TCHAR_TO_UTF8(*filepath);
+#endif
+		mScenePtr = Importer.ReadFile(file, flag);
+	}
+
+	UE_LOG(LogVRM4ULoader, Log, TEXT("VRM:(%3.3lf secs) ReadFileFromMemory"), FPlatformTime::Seconds() - StartTime);
+	FVrmLoadProfileScope::AddStage(TEXT("AssImp"), FPlatformTime::Seconds() - StartTime);
+	return mScenePtr;
+}
+
 bool ULoaderBPFunctionLibrary::LoadVRMFileFromMemory(const UVrmAssetListObject *InVrmAsset, UVrmAssetListObject *&OutVrmAsset, const FString filepath, const uint8 *pFileDataData, size_t dataSize) {
 	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("LoadVRMFileFromMemory"))
 
 	OutVrmAsset = nullptr;
-	RenderControl _dummy_control;
 
 	if (InVrmAsset == nullptr) {
 		return false;
 	}
 
 	Assimp::Importer mImporter;
-	mImporter.SetPropertyBool(AI_CONFIG_IMPORT_REMOVE_EMPTY_BONES, false);
 	const aiScene* mScenePtr = nullptr; // delete by Assimp::Importer::~Importer
 
-	if (filepath.IsEmpty())
+	VrmJson json;
 	{
+		const FString e_imp = SetVRMModelType(filepath, pFileDataData, dataSize, &json);
+		mScenePtr = ReadVRMScene(mImporter, e_imp, filepath, pFileDataData, dataSize, VRMConverter::Options::Get().IsSkipCompleteAttributeGeneration(), &json);
 	}
 
-	double StartTime = FPlatformTime::Seconds();
-	auto LogAndUpdate = [&](FString logname) {
-		UE_LOG(LogVRM4ULoader, Log, TEXT("VRM:(%02.2lf secs) %s"), FPlatformTime::Seconds() - StartTime, *logname);
-		StartTime = FPlatformTime::Seconds();
-	};
-
-	VRMConverter::Options::Get().SetVRM0Model(true);
-	{
-		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("AssImpLoader"))
-
-		const FString ext = FPaths::GetExtension(filepath).ToLower();
-#if PLATFORM_WINDOWS
-		std::string e = utf_16_to_shift_jis(*ext);
-		std::string e_imp = utf_16_to_shift_jis(*ext);
-#else
-		std::string e = TCHAR_TO_UTF8(*ext);
-		std::string e_imp = TCHAR_TO_UTF8(*ext);
-#endif
+	return LoadVRMFileFromScene(InVrmAsset, OutVrmAsset, filepath, pFileDataData, dataSize, mScenePtr, nullptr, &json);
+}
 
-		e_imp = GetExtAndSetModelTypeLocal(e, pFileDataData, dataSize);
+bool ULoaderBPFunctionLibrary::LoadVRMFileFromScene(const UVrmAssetListObject* InVrmAsset, UVrmAssetListObject*& OutVrmAsset, const FString filepath, const uint8* pFileDataData, size_t dataSize, const aiScene* mScenePtr, TArray<VRMUtil::FImportImage>* DecodedImageList, VrmJson* ParsedJson) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("LoadVRMFileFromScene"))
 
-		mScenePtr = mImporter.ReadFileFromMemory(pFileDataData, dataSize,
-			aiProcess_Triangulate | aiProcess_MakeLeftHanded | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals | aiProcess_OptimizeMeshes | aiProcess_PopulateArmatureData,
-			e_imp.c_str());
+	RenderControl _dummy_control;
 
-		if (mScenePtr == nullptr) {
-			std::string file;
-#if PLATFORM_WINDOWS
-			file = utf_16_to_shift_jis(*filepath);
-#else
-			file = TCHAR_TO_UTF8(*filepath);
-#endif
-			mScenePtr = mImporter.ReadFile(file, aiProcess_Triangulate | aiProcess_MakeLeftHanded | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals | aiProcess_OptimizeMeshes | aiProcess_PopulateArmatureData);
-		}
+	if (InVrmAsset == nullptr) {
+		return false;
+	}
 
-		UE_LOG(LogVRM4ULoader, Log, TEXT("VRM:(%3.3lf secs) ReadFileFromMemory"), FPlatformTime::Seconds() - StartTime);
+	double StartTime = FPlatformTime::Seconds();
+	auto LogAndUpdate = [&](FString logname) {
+		UE_LOG(LogVRM4ULoader, Log, TEXT("VRM:(%02.2lf secs) %s"), FPlatformTime::Seconds() - StartTime, *logname);
+		FVrmLoadProfileScope::AddStage(*logname, FPlatformTime::Seconds() - StartTime);
 		StartTime = FPlatformTime::Seconds();
-	}
+	};
 
 	UpdateProgress(20);
 	if (mScenePtr == nullptr)
@@ -742,6 +928,7 @@ bool ULoaderBPFunctionLibrary::LoadVRMFileFromMemory(const UVrmAssetListObject *
 		return false;
 	}
 
+	FString baseFileName;
 	{
 		FString fullpath = FPaths::GameUserDeveloperDir() + TEXT("VRM/");
 		FString basepath = FPackageName::FilenameToLongPackageName(fullpath);
@@ -789,7 +976,8 @@ bool ULoaderBPFunctionLibrary::LoadVRMFileFromMemory(const UVrmAssetListObject *
 	{
 		bool ret = true;
 		VRMConverter vc;
-		vc.Init(pFileDataData, dataSize, mScenePtr);
+		vc.Init(pFileDataData, dataSize, mScenePtr, ParsedJson);
+		vc.DecodedImageList = DecodedImageList;
 		vc.ConvertVrmFirst(out, pFileDataData, dataSize);
 
 		LogAndUpdate(TEXT("Begin convert"));
@@ -0,0 +1,79 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Modules/ModuleManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+
+#include "VrmLoadCache.h"
+#include "VrmTextureDedup.h"
+#include "VrmConvert.h"
+
+#include <assimp/scene.h>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FVrmLoadCacheDuplicateTextureTest, "VRM4U.LoadCache.DuplicateTexture",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::EngineFilter)
+
+bool FVrmLoadCacheDuplicateTextureTest::RunTest(const FString& Parameters)
+{
+	// 4x4 png. the same bytes are embedded twice
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+	TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG);
+	TArray<uint8> raw;
+	raw.SetNum(4 * 4 * 4);
+	for (int32 i = 0; i < raw.Num(); ++i) {
+		raw[i] = (uint8)(i * 7);
+	}
+	ImageWrapper->SetRaw(raw.GetData(), raw.Num(), 4, 4, ERGBFormat::BGRA, 8);
+	const auto& png = ImageWrapper->GetCompressed();
+	TestTrue(TEXT("png"), png.Num() > 0);
+
+	// textures are released by ~aiScene
+	aiScene scene;
+	scene.mNumTextures = 2;
+	scene.mTextures = new aiTexture*[2];
+	for (uint32 i = 0; i < scene.mNumTextures; ++i) {
+		aiTexture* t = new aiTexture();
+		t->mWidth = (unsigned int)png.Num();
+		t->mHeight = 0;
+		t->pcData = new aiTexel[(png.Num() + sizeof(aiTexel) - 1) / sizeof(aiTexel)];
+		FMemory::Memcpy(t->pcData, png.GetData(), png.Num());
+		scene.mTextures[i] = t;
+	}
+
+	VRMLoaderUtil::FImageProcessParam param;
+	param.NormalTable.SetNumZeroed(2);
+	param.bDedupTexture = true;
+
+	FVrmTextureDedup dedup;
+	dedup.Init(&scene, param);
+	TestEqual(TEXT("remap"), dedup.Remap[1], 0);
+	TestTrue(TEXT("skip duplicate"), dedup.SkipDecode[1]);
+
+	const uint64 key = FVrmLoadCache::GetSceneKey(&scene, &dedup.SkipDecode);
+	FVrmLoadCache::Remove(key);
+
+	// miss. decode and store
+	TArray<VRMUtil::FImportImage> imageList;
+	VRMLoaderUtil::DecodeSceneTextures(&scene, imageList, true, &dedup.SkipDecode);
+	TestEqual(TEXT("decoded num"), imageList.Num(), 2);
+	TestTrue(TEXT("decoded"), imageList[0].RawData.Num() > 0);
+	TestEqual(TEXT("duplicate is empty"), imageList[1].RawData.Num(), 0);
+
+	// hit
+	TArray<VRMUtil::FImportImage> cached;
+	TestTrue(TEXT("cache hit"), FVrmLoadCache::Load(key, cached));
+	TestEqual(TEXT("cached num"), cached.Num(), 2);
+	if (cached.Num() == 2) {
+		TestEqual(TEXT("cached size"), cached[0].RawData.Num(), imageList[0].RawData.Num());
+		TestEqual(TEXT("cached duplicate is empty"), cached[1].RawData.Num(), 0);
+	}
+
+	FVrmLoadCache::Remove(key);
+	return true;
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "Modules/ModuleManager.h"
 #include "Modules/ModuleInterface.h"
 #include "VRM4ULoaderLog.h"
+#include "VrmSharedAssetRegistry.h"
 
 #if PLATFORM_WINDOWS
 
@@ -132,6 +133,8 @@ class FVRM4ULoaderModule : public IModuleInterface {
 		// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 		// we call this function before unloading the module.
 
+		FVrmSharedAssetRegistry::Shutdown();
+
 #if PLATFORM_WINDOWS
 		if (assimpDllHandle){
 			FPlatformProcess::FreeDllHandle(assimpDllHandle);
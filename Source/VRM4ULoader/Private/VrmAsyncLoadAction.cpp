@@ -4,9 +4,14 @@
 #include "Async/TaskGraphInterfaces.h"
 #include "Engine/Texture2D.h"
 #include "Misc/FileHelper.h"
+#include "Modules/ModuleManager.h"
+#include "IImageWrapperModule.h"
 
 #include "LoaderBPFunctionLibrary.h"
 #include "VrmAssetListObject.h"
+#include "VrmLoadProfile.h"
+#include "VrmTextureDedup.h"
+#include "VrmSharedAssetRegistry.h"
 #include "VRM4ULoaderLog.h"
 
 
@@ -24,132 +29,177 @@
 #else
 #endif
 
-namespace {
-	class VrmLocalAsyncAsset {
-	public:
-		TArray<bool> NormalBoolTable;
-		TArray<bool> MaskBoolTable;
-		TArray<uint8> vrmLocalRes;
+class FVrmAsyncLoadContext {
+public:
+	TArray<bool> NormalBoolTable;
+	TArray<bool> MaskBoolTable;
+	TArray<VRMUtil::FImportImage> ImageList;
+	FVrmTextureDedup TextureDedup;
+	FVrmMappedFile File;
+	FString ImporterExt;
+	// parsed by SetVRMModelType. moved to VRMConverter on asset create
+	VrmJson Json;
+
+	Assimp::Importer* Importer = nullptr;
+	const aiScene* ScenePtr = nullptr;
+
+	// model type and import option of this load
+	VRMConverter::Options LoadOptions;
+
+	// worker tasks write to this only while the game thread is waiting
+	FVrmLoadProfile Profile;
+	bool bSuccess = false;
+
+	// FVrmSharedAssetRegistry. 0: not shared
+	FString ShareKeyText;
+	uint64 ShareKey = 0;
+
+	int TexCount = 0;
+	int SubCount = 0;
+	int FrameCount = 0;
+	double StartTime = 0.0;
+
+	~FVrmAsyncLoadContext() {
+		Reset();
+	}
+
+	void Reset() {
+		delete Importer;
+		Importer = nullptr;
+		ScenePtr = nullptr;
+		ImporterExt.Empty();
+		Json = VrmJson();
+
+		NormalBoolTable.Empty();
+		MaskBoolTable.Empty();
+		ImageList.Empty();
+		TextureDedup.Reset();
+		File.Close();
+	}
+};
 
-		Assimp::Importer* Importer = nullptr;
-		const aiScene* ScenePtr = nullptr;
+static void ConvTexInit(UVrmAssetListObject* vrmAssetList, FVrmAsyncLoadContext &localAsset) {
+	const aiScene* mScenePtr = localAsset.ScenePtr;
 
-		void Reset() {
-			delete Importer;
-			Importer = nullptr;
-			ScenePtr = nullptr;
+	localAsset.NormalBoolTable.Empty();
+	localAsset.MaskBoolTable.Empty();
+	vrmAssetList->Textures.Empty();
 
-			NormalBoolTable.Empty();
-			MaskBoolTable.Empty();
-			vrmLocalRes.Empty();
+	localAsset.NormalBoolTable.SetNum(mScenePtr->mNumTextures);
+	localAsset.MaskBoolTable.SetNum(mScenePtr->mNumTextures);
+	vrmAssetList->Textures.SetNum(mScenePtr->mNumTextures);
+
+	const VRM::VRMMetadata* meta = static_cast<const VRM::VRMMetadata*>(mScenePtr->mVRMMeta);
+	if (meta) {
+		for (int i = 0; i < meta->materialNum; ++i) {
+			int t = 0;
+
+			t = meta->material[i].textureProperties._BumpMap;
+			if (localAsset.NormalBoolTable.IsValidIndex(t)) {
+				localAsset.NormalBoolTable[t] = true;
+			}
+
+			t = meta->material[i].textureProperties._OutlineWidthTexture;
+			if (localAsset.MaskBoolTable.IsValidIndex(t)) {
+				localAsset.MaskBoolTable[t] = true;
+			}
 		}
-	};
-	VrmLocalAsyncAsset localAsset;
+	}
 }
 
-static bool ConvTex(UVrmAssetListObject* vrmAssetList, const aiScene* mScenePtr, const FImportOptionData* option, const int TexCount, const int SubCount) {
+// all textures at once. images are decoded by worker threads
+static void ConvTex(UVrmAssetListObject* vrmAssetList, FVrmAsyncLoadContext &localAsset, const FImportOptionData* option, const int SubCount) {
+	const aiScene* mScenePtr = localAsset.ScenePtr;
 	if (vrmAssetList == nullptr || mScenePtr == nullptr) {
-		return true;
+		return;
 	}
-	if ((int)mScenePtr->mNumTextures <= TexCount) {
-		return true;
+	if (vrmAssetList->Textures.Num() != (int)mScenePtr->mNumTextures) {
+		return;
 	}
 
-	if (TexCount == 0 && SubCount==0) {
-		localAsset.NormalBoolTable.Empty();
-		localAsset.MaskBoolTable.Empty();
-		vrmAssetList->Textures.Empty();
-
-		localAsset.NormalBoolTable.SetNum(mScenePtr->mNumTextures);
-		localAsset.MaskBoolTable.SetNum(mScenePtr->mNumTextures);
-		vrmAssetList->Textures.SetNum(mScenePtr->mNumTextures);
+	for (uint32_t i = 0; i < mScenePtr->mNumTextures; ++i) {
+		// duplicated or shared. set below / already set
+		if (localAsset.TextureDedup.IsCreateTexture(i) == false) {
+			continue;
+		}
 
-		const VRM::VRMMetadata* meta = static_cast<const VRM::VRMMetadata*>(mScenePtr->mVRMMeta);
-		if (meta) {
-			for (int i = 0; i < meta->materialNum; ++i) {
-				int t = 0;
+		if (SubCount == 0) {
+			auto& t = *mScenePtr->mTextures[i];
 
-				t = meta->material[i].textureProperties._BumpMap;
-				if (localAsset.NormalBoolTable.IsValidIndex(t)) {
-					localAsset.NormalBoolTable[t] = true;
-				}
+			FString baseName = VRMConverter::NormalizeFileName(t.mFilename.C_Str());
+			if (baseName.Len() == 0) {
+				baseName = TEXT("texture") + FString::FromInt(i);
+			}
+			bool bNormalGreenFlip = localAsset.NormalBoolTable[i];
+			if (bNormalGreenFlip) {
+				baseName += TEXT("_N");
+			}
 
-				t = meta->material[i].textureProperties._OutlineWidthTexture;
-				if (localAsset.MaskBoolTable.IsValidIndex(t)) {
-					localAsset.MaskBoolTable[t] = true;
-				}
+			FString name = FString(TEXT("T_")) + baseName;
+			auto* pkg = GetTransientPackage();
+			UTexture2D* NewTexture2D = nullptr;
+			if (localAsset.ImageList.IsValidIndex(i)) {
+				NewTexture2D = VRMLoaderUtil::CreateTextureFromDecodedImage(name, pkg, localAsset.ImageList[i], false, localAsset.NormalBoolTable[i], bNormalGreenFlip && (VRMConverter::IsImportMode() == false));
+				localAsset.ImageList[i] = VRMUtil::FImportImage();
 			}
+			vrmAssetList->Textures[i] = NewTexture2D;
 		}
-	}
 
-	if (mScenePtr->HasTextures()) {
-		// Note: PNG format.  Other formats are supported
-
-		//for (uint32_t i = 0; i < mScenePtr->mNumTextures; ++i) {
-		{
-			uint32_t i = TexCount;
-			if (SubCount == 0) {
-				auto& t = *mScenePtr->mTextures[i];
-				int Width = t.mWidth;
-				int Height = t.mHeight;
-
-				FString baseName = VRMConverter::NormalizeFileName(t.mFilename.C_Str());
-				if (baseName.Len() == 0) {
-					baseName = TEXT("texture") + FString::FromInt(i);
-				}
-				bool bNormalGreenFlip = localAsset.NormalBoolTable[i];
-				if (bNormalGreenFlip) {
-					baseName += TEXT("_N");
-				}
-
-				FString name = FString(TEXT("T_")) + baseName;
-				auto* pkg = GetTransientPackage();
-				UTexture2D* NewTexture2D = VRMLoaderUtil::CreateTextureFromImage(name, pkg, t.pcData, t.mWidth, false, localAsset.NormalBoolTable[i], bNormalGreenFlip&&(VRMConverter::IsImportMode() == false));
-				vrmAssetList->Textures[i] = NewTexture2D;
+		if (SubCount == 1) {
+			UTexture2D* NewTexture2D = vrmAssetList->Textures[i];
+			if (NewTexture2D == nullptr) {
+				continue;
 			}
 
-			if (SubCount == 1) {
-				UTexture2D* NewTexture2D = vrmAssetList->Textures[i];
-
 #if WITH_EDITOR
-				NewTexture2D->DeferCompression = false;
+			NewTexture2D->DeferCompression = false;
 #endif
 
-				// Set options
-				if (localAsset.NormalBoolTable[i]) {
-					NewTexture2D->CompressionSettings = TC_Normalmap;
-					NewTexture2D->SRGB = 0;
+			// Set options
+			if (localAsset.NormalBoolTable[i]) {
+				NewTexture2D->CompressionSettings = TC_Normalmap;
+				NewTexture2D->SRGB = 0;
 #if WITH_EDITOR
-					if (VRMConverter::IsImportMode()) {
-						NewTexture2D->bFlipGreenChannel = true;
-					}
-#endif
-				}
-				if (localAsset.MaskBoolTable[i]) {
-					// comment for material warning...
-					//NewTexture2D->SRGB = 0;
+				if (VRMConverter::IsImportMode()) {
+					NewTexture2D->bFlipGreenChannel = true;
 				}
+#endif
+			}
+			if (localAsset.MaskBoolTable[i]) {
+				// comment for material warning...
+				//NewTexture2D->SRGB = 0;
+			}
 
-				if (NewTexture2D->SRGB) {
-					if (option->bBC7Mode) {
-						NewTexture2D->CompressionSettings = TC_BC7;
-					}
+			if (NewTexture2D->SRGB) {
+				if (option->bBC7Mode) {
+					NewTexture2D->CompressionSettings = TC_BC7;
 				}
-				if (option->bMipmapGenerateMode == false) {
+			}
+			if (option->bMipmapGenerateMode == false) {
 #if WITH_EDITORONLY_DATA
-					NewTexture2D->MipGenSettings = TMGS_NoMipmaps;
+				NewTexture2D->MipGenSettings = TMGS_NoMipmaps;
 #endif
-				}
+			}
 
-				NewTexture2D->UpdateResource();
+			NewTexture2D->UpdateResource();
 #if WITH_EDITOR
-				//NewTexture2D->PostEditChange();
+			//NewTexture2D->PostEditChange();
 #endif
+			if (localAsset.TextureDedup.bShare) {
+				FVrmTextureDedup::AddShared(localAsset.TextureDedup.Hash[i], NewTexture2D);
+			}
+		}
+	}
+	if (SubCount == 0) {
+		localAsset.ImageList.Empty();
 
+		const auto& remap = localAsset.TextureDedup.Remap;
+		for (int i = 0; i < remap.Num(); ++i) {
+			if (remap[i] != i) {
+				vrmAssetList->Textures[i] = vrmAssetList->Textures[remap[i]];
 			}
 		}
 	}
-	return false;
 }
 
 
@@ -161,6 +211,14 @@ FVrmAsyncLoadAction::FVrmAsyncLoadAction(const FLatentActionInfo& LatentInfo, FV
 	, CallbackTarget(LatentInfo.CallbackTarget)
 	, param(p)
 	{
+	Context = MakeShared<FVrmAsyncLoadContext, ESPMode::ThreadSafe>();
+
+	// copy current settings (material type etc), then bind to the option owned by this action
+	Context->LoadOptions = VRMConverter::Options::Get();
+	Context->LoadOptions.SetVrmOption(&param.OptionForRuntimeLoad);
+}
+
+FVrmAsyncLoadAction::~FVrmAsyncLoadAction() {
 }
 
 
@@ -172,15 +230,21 @@ void FVrmAsyncLoadAction::UpdateOperation(FLatentResponse& Response)
 		Init,
 		FileWait,
 		AssImp,
+		AssImpWait,
+		TextureDecode,
+		TextureDecodeWait,
 		TextureLoop,
 		AssetCreate,
 		Finish,
 	};
 
-	static int TexCount = 0;
-	static int SubCount = 0;
-	static int FrameCount = 0;
-	static double StartTime = 0.f;
+	FVrmAsyncLoadContext& localAsset = *Context;
+	VRMConverter::Options::Scope OptionScope(localAsset.LoadOptions);
+
+	int& TexCount = localAsset.TexCount;
+	int& SubCount = localAsset.SubCount;
+	int& FrameCount = localAsset.FrameCount;
+	double& StartTime = localAsset.StartTime;
 	++FrameCount;
 
 	auto logFunc = [&](FString str="") {
@@ -197,15 +261,27 @@ void FVrmAsyncLoadAction::UpdateOperation(FLatentResponse& Response)
 		SubCount = 0;
 		FrameCount = 0;
 		StartTime = FPlatformTime::Seconds();
+		localAsset.Profile.Begin(param.filepath);
 		logFunc("Begin");
 		++SequenceCount;
 
 
-		TFunction< void() > f = [&] {
-			if (FFileHelper::LoadFileToArray(localAsset.vrmLocalRes, *param.filepath)) {
-				param.pData = localAsset.vrmLocalRes.GetData();
-				param.dataSize = localAsset.vrmLocalRes.Num();
+		localAsset.ShareKey = 0;
+		localAsset.ShareKeyText.Empty();
+		if (localAsset.LoadOptions.IsRuntimeShareAsset()) {
+			localAsset.ShareKeyText = FVrmSharedAssetRegistry::GetOptionKeyText(&param.OptionForRuntimeLoad, param.InVrmAsset);
+		}
+
+		TSharedPtr<FVrmAsyncLoadContext, ESPMode::ThreadSafe> ctx = Context;
+		const FString filepath = param.filepath;
+		TFunction< void() > f = [ctx, filepath] {
+			const double t = FPlatformTime::Seconds();
+			ctx->File.Open(filepath);
+			ctx->Profile.FileSizeMB = (float)((double)ctx->File.Num() / (1024.0 * 1024.0));
+			if (ctx->ShareKeyText.Len()) {
+				ctx->ShareKey = FVrmSharedAssetRegistry::MakeKey(ctx->File.GetData(), ctx->File.Num(), ctx->ShareKeyText);
 			}
+			ctx->Profile.AddStage(TEXT("ReadFile"), FPlatformTime::Seconds() - t);
 		};
 
 		auto p2 = ENamedThreads::AnyBackgroundThreadNormalTask;
@@ -220,6 +296,22 @@ void FVrmAsyncLoadAction::UpdateOperation(FLatentResponse& Response)
 			logFunc();
 			++SequenceCount;
 
+			if (localAsset.ShareKey) {
+				if (UVrmAssetListObject* shared = FVrmSharedAssetRegistry::Get().Acquire(localAsset.ShareKey)) {
+					// same file and options. skip conversion
+					param.OutVrmAsset = shared;
+					localAsset.Profile.bSharedAsset = true;
+					localAsset.bSuccess = true;
+					localAsset.ShareKey = 0;
+					SequenceCount = (int)ESequenceNo::Finish;
+					return;
+				}
+			}
+
+			if (localAsset.File.Num() > 0) {
+				param.pData = localAsset.File.GetData();
+				param.dataSize = localAsset.File.Num();
+			}
 			param.OutVrmAsset = Cast<UVrmAssetListObject>(StaticDuplicateObject(param.InVrmAsset, GetTransientPackage(), NAME_None));
 		}
 		return;
@@ -230,37 +322,86 @@ void FVrmAsyncLoadAction::UpdateOperation(FLatentResponse& Response)
 		logFunc();
 		++SequenceCount;
 
+		// model type is global. set on game thread
+		localAsset.ImporterExt = ULoaderBPFunctionLibrary::SetVRMModelType(param.filepath, localAsset.File.GetData(), localAsset.File.Num(), &localAsset.Json);
 		localAsset.Importer = new Assimp::Importer();
-		localAsset.ScenePtr = localAsset.Importer->ReadFileFromMemory(localAsset.vrmLocalRes.GetData(), localAsset.vrmLocalRes.Num(),
-			aiProcess_Triangulate | aiProcess_MakeLeftHanded | aiProcess_CalcTangentSpace | aiProcess_GenSmoothNormals | aiProcess_OptimizeMeshes,
-			"vrm");
+
+		// parse once on worker thread. the scene is used by texture loop and asset create
+		TSharedPtr<FVrmAsyncLoadContext, ESPMode::ThreadSafe> ctx = Context;
+		const FString filepath = param.filepath;
+		const bool bSkipCompleteAttribute = localAsset.LoadOptions.IsSkipCompleteAttributeGeneration();
+		TFunction< void() > f = [ctx, filepath, bSkipCompleteAttribute] {
+			FVrmLoadProfileScope ProfileScope(ctx->Profile);
+			ctx->ScenePtr = ULoaderBPFunctionLibrary::ReadVRMScene(*ctx->Importer, ctx->ImporterExt, filepath, ctx->File.GetData(), ctx->File.Num(), bSkipCompleteAttribute, &ctx->Json);
+		};
+		t2 = FFunctionGraphTask::CreateAndDispatchWhenReady(f, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
 		return;
 	}
 
-	if (SequenceCount == (int)ESequenceNo::TextureLoop) {
-		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*FString::Printf(TEXT("VRMLoad UpdateOperation texture %d"), SubCount))
-		if (localAsset.ScenePtr == nullptr) {
+	if (SequenceCount == (int)ESequenceNo::AssImpWait) {
+		if (t2->IsComplete()) {
+			logFunc();
+			++SequenceCount;
+		}
+		return;
+	}
+
+	if (SequenceCount == (int)ESequenceNo::TextureDecode) {
+		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRMLoad UpdateOperation texture decode"))
+		if (localAsset.ScenePtr == nullptr || param.OutVrmAsset == nullptr) {
+			UE_LOG(LogVRM4ULoader, Warning, TEXT("AsyncLoad: read failure. %s"), *param.filepath);
+			localAsset.Profile.End(nullptr, false);
+			FVrmLoadProfile::SetLastProfile(localAsset.Profile);
 			Response.FinishAndTriggerIf(true, ExecutionFunction, OutputLink, CallbackTarget);
 			localAsset.Reset();
 			return;
 		}
+		logFunc();
+		++SequenceCount;
 
-		if (TexCount < (int)localAsset.ScenePtr->mNumTextures) {
+		ConvTexInit(param.OutVrmAsset, localAsset);
 
-			if (SubCount == 0) {
-				ConvTex(param.OutVrmAsset, localAsset.ScenePtr, &param.OptionForRuntimeLoad, TexCount, 0);
-			}
-			if (SubCount == 2) {
-				ConvTex(param.OutVrmAsset, localAsset.ScenePtr, &param.OptionForRuntimeLoad, TexCount, 1);
-			}
-			++SubCount;
+		// module load is game thread only
+		FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
 
-			if (SubCount >= 4) {
-				logTexFunc(TexCount);
-				++TexCount;
-				SubCount = 0;
-			}
-		} else {
+		// decode all images in parallel into staging buffers
+		TSharedPtr<FVrmAsyncLoadContext, ESPMode::ThreadSafe> ctx = Context;
+		const bool bUseLoadCache = localAsset.LoadOptions.IsLoadCache();
+		const VRMLoaderUtil::FImageProcessParam processParam = VRMLoaderUtil::GetImageProcessParam(localAsset.NormalBoolTable);
+
+		// same images. decoded once. shared textures are held by the asset list until ConvTex
+		localAsset.TextureDedup.Init(localAsset.ScenePtr, processParam);
+		localAsset.TextureDedup.FindShared(param.OutVrmAsset->Textures);
+
+		TFunction< void() > f = [ctx, bUseLoadCache, processParam] {
+			FVrmLoadProfileScope ProfileScope(ctx->Profile);
+			VRMLoaderUtil::DecodeSceneTextures(ctx->ScenePtr, ctx->ImageList, bUseLoadCache, &ctx->TextureDedup.SkipDecode);
+			VRMLoaderUtil::ProcessSceneImages(ctx->ImageList, processParam);
+		};
+		t2 = FFunctionGraphTask::CreateAndDispatchWhenReady(f, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+		return;
+	}
+
+	if (SequenceCount == (int)ESequenceNo::TextureDecodeWait) {
+		if (t2->IsComplete()) {
+			logFunc();
+			++SequenceCount;
+		}
+		return;
+	}
+
+	if (SequenceCount == (int)ESequenceNo::TextureLoop) {
+		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(*FString::Printf(TEXT("VRMLoad UpdateOperation texture %d"), SubCount))
+
+		// 0: create and fill all textures  1: options and UpdateResource
+		const double t = FPlatformTime::Seconds();
+		ConvTex(param.OutVrmAsset, localAsset, &param.OptionForRuntimeLoad, SubCount);
+		localAsset.Profile.AddStage(TEXT("CreateTexture"), FPlatformTime::Seconds() - t);
+		++SubCount;
+
+		if (SubCount >= 2) {
+			TexCount = (int)localAsset.ScenePtr->mNumTextures;
+			logTexFunc(TexCount);
 			logFunc();
 			++SequenceCount;
 		}
@@ -272,10 +413,14 @@ void FVrmAsyncLoadAction::UpdateOperation(FLatentResponse& Response)
 		TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRMLoad UpdateOperation asset"))
 		logFunc();
 		++SequenceCount;
-		if (param.pData) {
-			ULoaderBPFunctionLibrary::LoadVRMFileFromMemory(param.InVrmAsset, param.OutVrmAsset, param.filepath, param.pData, param.dataSize);
-		} else {
-			ULoaderBPFunctionLibrary::LoadVRMFile(param.InVrmAsset, param.OutVrmAsset, param.filepath, param.OptionForRuntimeLoad);
+		{
+			// always the scene and buffer of the read stage. never read the file again
+			FVrmLoadProfileScope ProfileScope(localAsset.Profile);
+			localAsset.bSuccess = ULoaderBPFunctionLibrary::LoadVRMFileFromScene(param.InVrmAsset, param.OutVrmAsset, param.filepath, localAsset.File.GetData(), localAsset.File.Num(), localAsset.ScenePtr, nullptr, &localAsset.Json);
+		}
+		if (localAsset.bSuccess && localAsset.ShareKey) {
+			// the live one wins if the same model was converted meanwhile
+			param.OutVrmAsset = FVrmSharedAssetRegistry::Get().Register(localAsset.ShareKey, param.OutVrmAsset);
 		}
 		return;
 	}
@@ -283,6 +428,9 @@ void FVrmAsyncLoadAction::UpdateOperation(FLatentResponse& Response)
 	if (SequenceCount == (int)ESequenceNo::Finish) {
 		logFunc("End");
 
+		localAsset.Profile.End(param.OutVrmAsset, localAsset.bSuccess);
+		FVrmLoadProfile::SetLastProfile(localAsset.Profile);
+
 		Response.FinishAndTriggerIf(true, ExecutionFunction, OutputLink, CallbackTarget);
 		localAsset.Reset();
 	}
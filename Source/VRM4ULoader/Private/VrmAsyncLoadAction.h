@@ -22,6 +22,8 @@ public:
 };
 
 
+class FVrmAsyncLoadContext;
+
 class FVrmAsyncLoadAction : public FPendingLatentAction
 {
 public:
@@ -34,7 +36,11 @@ public:
 
 	FVrmAsyncLoadActionParam param;
 
+	// per-load state. shared with worker tasks
+	TSharedPtr<FVrmAsyncLoadContext, ESPMode::ThreadSafe> Context;
+
 	FVrmAsyncLoadAction(const FLatentActionInfo& LatentInfo, FVrmAsyncLoadActionParam &);
+	virtual ~FVrmAsyncLoadAction();
 
 	virtual void UpdateOperation(FLatentResponse& Response) override;
 
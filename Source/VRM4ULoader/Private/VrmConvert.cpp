@@ -246,11 +246,28 @@ bool VRMConverter::NormalizeBoneName(const aiScene *mScenePtr) {
 
 ////
 
+namespace {
+	// per-load options, set by Options::Scope
+	thread_local VRMConverter::Options* s_activeOptions = nullptr;
+}
+
 VRMConverter::Options& VRMConverter::Options::Get(){
 	static VRMConverter::Options o;
+	if (s_activeOptions) {
+		return *s_activeOptions;
+	}
 	return o;
 }
 
+VRMConverter::Options::Scope::Scope(Options& o) {
+	prev = s_activeOptions;
+	s_activeOptions = &o;
+}
+
+VRMConverter::Options::Scope::~Scope() {
+	s_activeOptions = prev;
+}
+
 USkeleton *VRMConverter::Options::GetSkeleton() {
 	if (ImportOption == nullptr) return nullptr;
 
@@ -350,14 +367,19 @@ bool VRMConverter::Options::IsMobileBone() const {
 
 int VRMConverter::Options::GetBoneWeightInfluenceNum() const {
 	int ret = 8;
-
-#if WITH_EDITOR
 	if (ImportOption == nullptr) return ret;
 
 	return FMath::Clamp(ImportOption->BoneWeightInfluenceNum, 1, 8);
-#else
-	return ret;
-#endif
+}
+
+float VRMConverter::Options::GetBoneWeightPruneThreshold() const {
+	if (ImportOption == nullptr) return 0.f;
+	return FMath::Clamp(ImportOption->BoneWeightPruneThreshold, 0.f, 0.5f);
+}
+
+bool VRMConverter::Options::IsBoneWeight8Bit() const {
+	if (ImportOption == nullptr) return false;
+	return ImportOption->bBoneWeight8Bit;
 }
 
 
@@ -475,6 +497,88 @@ bool VRMConverter::Options::IsMipmapGenerateMode() const {
 #endif
 }
 
+bool VRMConverter::Options::IsSkipCompleteAttributeGeneration() const {
+	if (ImportOption == nullptr) return true;
+	return ImportOption->bSkipCompleteAttributeGeneration;
+}
+
+bool VRMConverter::Options::IsLoadCache() const {
+	if (ImportOption == nullptr) return false;
+	if (VRMConverter::IsImportMode()) return false;
+	return ImportOption->bUseLoadCache;
+}
+
+bool VRMConverter::Options::IsRuntimeTextureCompress() const {
+	if (ImportOption == nullptr) return false;
+	if (VRMConverter::IsImportMode()) return false;
+	return ImportOption->bRuntimeTextureCompress;
+}
+
+int VRMConverter::Options::GetRuntimeTextureCompressQuality() const {
+	if (ImportOption == nullptr) return 1;
+	return ImportOption->RuntimeTextureCompressQuality;
+}
+
+bool VRMConverter::Options::IsRuntimeGenerateMips() const {
+	if (ImportOption == nullptr) return false;
+	if (VRMConverter::IsImportMode()) return false;
+	return ImportOption->bRuntimeGenerateMips;
+}
+
+int VRMConverter::Options::GetRuntimeTextureMaxSize() const {
+	if (ImportOption == nullptr) return 0;
+	if (VRMConverter::IsImportMode()) return 0;
+	return FMath::Max(ImportOption->RuntimeTextureMaxSize, 0);
+}
+
+int VRMConverter::Options::GetRuntimeTextureBudgetMB() const {
+	if (ImportOption == nullptr) return 0;
+	if (VRMConverter::IsImportMode()) return 0;
+	return FMath::Max(ImportOption->RuntimeTextureBudgetMB, 0);
+}
+
+bool VRMConverter::Options::IsRuntimeTextureDedup() const {
+	if (ImportOption == nullptr) return false;
+	if (VRMConverter::IsImportMode()) return false;
+	return ImportOption->bRuntimeTextureDedup;
+}
+
+bool VRMConverter::Options::IsRuntimeTextureShare() const {
+	if (ImportOption == nullptr) return false;
+	if (VRMConverter::IsImportMode()) return false;
+	return ImportOption->bRuntimeTextureShare;
+}
+
+bool VRMConverter::Options::IsRuntimeShareAsset() const {
+	if (ImportOption == nullptr) return false;
+	if (VRMConverter::IsImportMode()) return false;
+	return ImportOption->bRuntimeShareAsset;
+}
+
+int VRMConverter::Options::GetRuntimeLODNum() const {
+	if (ImportOption == nullptr) return 0;
+	if (VRMConverter::IsImportMode()) return 0;
+	if (ImportOption->bRuntimeGenerateLOD == false) return 0;
+	return FMath::Clamp(ImportOption->RuntimeLODNum, 0, 3);
+}
+
+float VRMConverter::Options::GetRuntimeLODTriangleRatio(int LODIndex) const {
+	// LODIndex 1..
+	float ret = FMath::Pow(0.5f, (float)LODIndex);
+	if (ImportOption && ImportOption->RuntimeLODTriangleRatio.IsValidIndex(LODIndex - 1)) {
+		ret = ImportOption->RuntimeLODTriangleRatio[LODIndex - 1];
+	}
+	return FMath::Clamp(ret, 0.01f, 1.f);
+}
+
+float VRMConverter::Options::GetRuntimeLODScreenSize(int LODIndex) const {
+	float ret = 0.6f * FMath::Pow(0.5f, (float)LODIndex);
+	if (ImportOption && ImportOption->RuntimeLODScreenSize.IsValidIndex(LODIndex - 1)) {
+		ret = ImportOption->RuntimeLODScreenSize[LODIndex - 1];
+	}
+	return FMath::Max(ret, 0.f);
+}
+
 bool VRMConverter::Options::IsGenerateOutlineMaterial() const {
 	bool ret = true;
 	if (ImportOption == nullptr) return true;
@@ -504,13 +608,22 @@ bool VRMConverter::Options::IsRemoveDegenerateTriangles() const {
 	return ImportOption->bRemoveDegenerateTriangles;
 }
 
+bool VRMConverter::Options::IsOptimizeVertexCache() const {
+	if (ImportOption == nullptr) return false;
+	return ImportOption->bOptimizeVertexCache;
+}
+
+bool VRMConverter::Options::IsOptimizeOverdraw() const {
+	if (ImportOption == nullptr) return false;
+	if (ImportOption->bOptimizeVertexCache == false) return false;
+	return ImportOption->bOptimizeOverdraw;
+}
+
 bool VRMConverter::Options::IsUE5Material() const {
 	if (ImportOption == nullptr) return false;
 	return ImportOption->bUseUE5Material;
 }
 
-static bool bbVRM0 = false;
-static bool bbVRM10 = false;
 void VRMConverter::Options::SetVRM0Model(bool bVRM) {
 	bbVRM0 = bVRM;
 	bbVRM10 = !bVRM;
@@ -573,7 +686,6 @@ bool VRMConverter::Options::IsVRMModel() const {
 	return IsVRM0Model() || IsVRM10Model();
 }
 
-static bool bbVRMA = false;
 void VRMConverter::Options::SetVRMAModel(bool bVRMA) {
 	bbVRMA = bVRMA;
 }
@@ -582,7 +694,6 @@ bool VRMConverter::Options::IsVRMAModel() const {
 	return bbVRMA;
 }
 
-static bool bbBVH = false;
 void VRMConverter::Options::SetBVHModel(bool bBVH) {
 	bbBVH = bBVH;
 }
@@ -591,7 +702,6 @@ bool VRMConverter::Options::IsBVHModel() const {
 	return bbBVH;
 }
 
-static bool bbPMX = false;
 void VRMConverter::Options::SetPMXModel(bool bVRM) {
 	bbPMX = bVRM;
 }
@@ -600,7 +710,6 @@ bool VRMConverter::Options::IsPMXModel() const {
 	return bbPMX;
 }
 
-static bool bbNoMesh = false;
 void VRMConverter::Options::SetNoMesh(bool bNoMesh) {
 	bbNoMesh = bNoMesh;
 }
@@ -658,7 +767,6 @@ bool VRMConverter::Options::IsAPoseRetarget() const {
 }
 
 
-static EVRMImportMaterialType mType = EVRMImportMaterialType::VRMIMT_Auto;
 void VRMConverter::Options::SetMaterialType(EVRMImportMaterialType t) {
 	mType = t;
 }
@@ -27,13 +27,99 @@
 #include <assimp/vrm/vrmmeta.h>
 
 
-bool VRMConverter::Init(const uint8* pFileData, size_t dataSize, const aiScene *pScene) {
-	jsonData.init(pFileData, dataSize);
+bool VRMConverter::Init(const uint8* pFileData, size_t dataSize, const aiScene *pScene, VrmJson* ParsedJson) {
+	if (ParsedJson && ParsedJson->IsEnable()) {
+		jsonData = MoveTemp(*ParsedJson);
+	} else {
+		jsonData.init(pFileData, dataSize);
+	}
 	aiData = pScene;
 	return true;
 }
 
 
+namespace {
+	void LocalSetLicense0(UVrmLicenseObject* lic0, const FString& key, const FString& value) {
+		struct TT {
+			const TCHAR* key;
+			FString &dst;
+		};
+		const TT table[] = {
+			{TEXT("version"),		lic0->version},
+			{TEXT("author"),			lic0->author},
+			{TEXT("contactInformation"),	lic0->contactInformation},
+			{TEXT("reference"),		lic0->reference},
+				// texture skip
+			{TEXT("title"),			lic0->title},
+			{TEXT("allowedUserName"),	lic0->allowedUserName},
+			{TEXT("violentUsageName"),	lic0->violentUsageName},
+			{TEXT("sexualUsageName"),	lic0->sexualUsageName},
+			{TEXT("commercialUsageName"),	lic0->commercialUsageName},
+			{TEXT("otherPermissionUrl"),		lic0->otherPermissionUrl},
+			{TEXT("licenseName"),			lic0->licenseName},
+			{TEXT("otherLicenseUrl"),		lic0->otherLicenseUrl},
+
+			{TEXT("violentUssageName"),	lic0->violentUsageName},
+			{TEXT("sexualUssageName"),	lic0->sexualUsageName},
+			{TEXT("commercialUssageName"),	lic0->commercialUsageName},
+		};
+		for (auto &t : table) {
+			if (key == t.key) {
+				t.dst = value;
+			}
+		}
+	}
+
+	// VRMC_vrm.meta. thumbnailImage is handled by caller
+	void LocalSetLicense1(UVrm1LicenseObject* lic1, const RAPIDJSON_NAMESPACE::Value& meta) {
+		if (meta.IsObject() == false) {
+			return;
+		}
+		for (auto m = meta.MemberBegin(); m != meta.MemberEnd(); ++m) {
+
+			FString key = UTF8_TO_TCHAR((*m).name.GetString());
+
+			if (key.Find("allow") == 0) {
+				if ((*m).value.IsBool() == false) {
+					continue;
+				}
+				FLicenseBoolDataPair p;
+				p.key = key;
+				p.value = (*m).value.GetBool();
+				lic1->LicenseBool.Add(p);
+			} else if (key == "thumbnailImage") {
+			}else{
+				if ((*m).value.IsArray()) {
+					int ind = 0;
+					bool bFound = false;
+					for (auto& a : lic1->LicenseStringArray) {
+						if (a.key != key) {
+							++ind;
+							continue;
+						}
+						bFound = true;
+						break;
+					}
+					if (bFound == false) {
+						ind = lic1->LicenseStringArray.AddDefaulted();
+						lic1->LicenseStringArray[ind].key = key;
+					}
+					for (auto& a : (*m).value.GetArray()) {
+						if (a.IsString()) {
+							lic1->LicenseStringArray[ind].value.Add(UTF8_TO_TCHAR(a.GetString()));
+						}
+					}
+				} else if ((*m).value.IsString()) {
+					FLicenseStringDataPair p;
+					p.key = key;
+					p.value = UTF8_TO_TCHAR((*m).value.GetString());
+					lic1->LicenseString.Add(p);
+				}
+			}
+		}
+	}
+}
+
 static UVrmLicenseObject* tmpLicense0 = nullptr;
 static UVrm1LicenseObject* tmpLicense1 = nullptr;
 void VRMConverter::GetVRMMeta(const aiScene *mScenePtr, UVrmLicenseObject *& a, UVrm1LicenseObject *& b) {
@@ -45,6 +131,75 @@ void VRMConverter::GetVRMMeta(const aiScene *mScenePtr, UVrmLicenseObject *& a,
 	b = tmpLicense1;
 }
 
+bool VRMConverter::GetVRMMetaFromJson(UVrmLicenseObject*& a, UVrm1LicenseObject*& b, int& ThumbnailImage) const {
+	a = nullptr;
+	b = nullptr;
+	ThumbnailImage = -1;
+
+	// file is not validated by assimp yet. false on unexpected types, the caller falls back to assimp
+	if (jsonData.IsEnable() == false || jsonData.doc.HasMember("extensions") == false || jsonData.doc["extensions"].IsObject() == false) {
+		return false;
+	}
+	const auto& ext = jsonData.doc["extensions"];
+	auto isObject = [](const RAPIDJSON_NAMESPACE::Value& v, const char* name) {
+		return v.HasMember(name) && v[name].IsObject();
+	};
+
+	if (isObject(ext, "VRMC_vrm")) {
+		if (isObject(ext["VRMC_vrm"], "meta") == false) {
+			return false;
+		}
+		const auto& meta = ext["VRMC_vrm"]["meta"];
+		if (meta.HasMember("thumbnailImage")) {
+			if (meta["thumbnailImage"].IsInt() == false || meta["thumbnailImage"].GetInt() < 0) {
+				return false;
+			}
+			ThumbnailImage = meta["thumbnailImage"].GetInt();
+		}
+
+		UVrm1LicenseObject* lic1 = VRM4U_NewObject<UVrm1LicenseObject>(GetTransientPackage(), NAME_None, EObjectFlags::RF_Public | RF_Transient, NULL);
+		LocalSetLicense1(lic1, meta);
+		b = lic1;
+		return true;
+	}
+
+	if (isObject(ext, "VRM")) {
+		if (isObject(ext["VRM"], "meta") == false) {
+			return false;
+		}
+		const auto& meta = ext["VRM"]["meta"];
+
+		// vrm0 meta.texture is a texture index
+		if (meta.HasMember("texture")) {
+			if (meta["texture"].IsInt() == false || jsonData.doc.HasMember("textures") == false || jsonData.doc["textures"].IsArray() == false) {
+				return false;
+			}
+			const int t = meta["texture"].GetInt();
+			const auto& textures = jsonData.doc["textures"];
+			if (t < 0 || t >= (int)textures.Size() || textures[t].IsObject() == false) {
+				return false;
+			}
+			if (textures[t].HasMember("source")) {
+				if (textures[t]["source"].IsInt() == false || textures[t]["source"].GetInt() < 0) {
+					return false;
+				}
+				ThumbnailImage = textures[t]["source"].GetInt();
+			}
+		}
+
+		UVrmLicenseObject* lic0 = VRM4U_NewObject<UVrmLicenseObject>(GetTransientPackage(), NAME_None, EObjectFlags::RF_Public | RF_Transient, NULL);
+		for (auto m = meta.MemberBegin(); m != meta.MemberEnd(); ++m) {
+			if ((*m).value.IsString()) {
+				LocalSetLicense0(lic0, UTF8_TO_TCHAR((*m).name.GetString()), UTF8_TO_TCHAR((*m).value.GetString()));
+			}
+		}
+
+		a = lic0;
+		return true;
+	}
+	return false;
+}
+
 bool VRMConverter::ConvertVrmFirst(UVrmAssetListObject* vrmAssetList, const uint8* pData, size_t dataSize) {
 
 	// material
@@ -614,85 +769,23 @@ bool VRMConverter::ConvertVrmMeta(UVrmAssetListObject* vrmAssetList, const aiSce
 		// license
 	if (VRMConverter::Options::Get().IsVRM10Model()) {
 		auto& meta = jsonData.doc["extensions"]["VRMC_vrm"]["meta"];
-		for (auto m = meta.MemberBegin(); m != meta.MemberEnd(); ++m) {
-
-			FString key = UTF8_TO_TCHAR((*m).name.GetString());
+		LocalSetLicense1(lic1, meta);
 
-			if (key.Find("allow") == 0) {
-				FLicenseBoolDataPair p;
-				p.key = key;
-				p.value = (*m).value.GetBool();
-				lic1->LicenseBool.Add(p);
-			} else if (key == "thumbnailImage") {
-				if (vrmAssetList) {
-					int t = (*m).value.GetInt();
-					if (t >= 0 && t < vrmAssetList->Textures.Num()) {
-						lic1->thumbnail = vrmAssetList->Textures[t];
+		if (vrmAssetList && meta.HasMember("thumbnailImage")) {
+			int t = meta["thumbnailImage"].GetInt();
+			if (t >= 0 && t < vrmAssetList->Textures.Num()) {
+				lic1->thumbnail = vrmAssetList->Textures[t];
 #if WITH_EDITORONLY_DATA
-						vrmAssetList->SmallThumbnailTexture = lic1->thumbnail;
+				vrmAssetList->SmallThumbnailTexture = lic1->thumbnail;
 #endif
-					}
-				}
-			}else{
-				if ((*m).value.IsArray()) {
-					int ind = 0;
-					bool bFound = false;
-					for (auto& a : lic1->LicenseStringArray) {
-						if (a.key != key) {
-							++ind;
-							continue;
-						}
-						bFound = true;
-						break;
-					}
-					if (bFound == false) {
-						ind = lic1->LicenseStringArray.AddDefaulted();
-						lic1->LicenseStringArray[ind].key = key;
-					}
-					for (auto& a : (*m).value.GetArray()) {
-						lic1->LicenseStringArray[ind].value.Add(UTF8_TO_TCHAR(a.GetString()));
-					}
-				} else {
-					FLicenseStringDataPair p;
-					p.key = key;
-					p.value = UTF8_TO_TCHAR((*m).value.GetString());
-					lic1->LicenseString.Add(p);
-				}
 			}
 		}
 	}else {
-		struct TT {
-			FString key;
-			FString &dst;
-		};
-		const TT table[] = {
-			{TEXT("version"),		lic0->version},
-			{TEXT("author"),			lic0->author},
-			{TEXT("contactInformation"),	lic0->contactInformation},
-			{TEXT("reference"),		lic0->reference},
-				// texture skip
-			{TEXT("title"),			lic0->title},
-			{TEXT("allowedUserName"),	lic0->allowedUserName},
-			{TEXT("violentUsageName"),	lic0->violentUsageName},
-			{TEXT("sexualUsageName"),	lic0->sexualUsageName},
-			{TEXT("commercialUsageName"),	lic0->commercialUsageName},
-			{TEXT("otherPermissionUrl"),		lic0->otherPermissionUrl},
-			{TEXT("licenseName"),			lic0->licenseName},
-			{TEXT("otherLicenseUrl"),		lic0->otherLicenseUrl},
-
-			{TEXT("violentUssageName"),	lic0->violentUsageName},
-			{TEXT("sexualUssageName"),	lic0->sexualUsageName},
-			{TEXT("commercialUssageName"),	lic0->commercialUsageName},
-		};
 		for (int i = 0; i < SceneMeta->license.licensePairNum; ++i) {
 
 			auto &p = SceneMeta->license.licensePair[i];
 
-			for (auto &t : table) {
-				if (t.key == p.Key.C_Str()) {
-					t.dst = UTF8_TO_TCHAR(p.Value.C_Str());
-				}
-			}
+			LocalSetLicense0(lic0, UTF8_TO_TCHAR(p.Key.C_Str()), UTF8_TO_TCHAR(p.Value.C_Str()));
 			if (vrmAssetList) {
 				if (FString(TEXT("texture")) == p.Key.C_Str()) {
 					int t = FCString::Atoi(*FString(p.Value.C_Str()));
@@ -11,6 +11,10 @@
 #include "VrmSkeleton.h"
 #include "LoaderBPFunctionLibrary.h"
 #include "VRM4ULoaderLog.h"
+#include "VrmMeshOptimize.h"
+#include "VrmMeshSimplify.h"
+#include "VrmSkinWeight.h"
+#include "VrmLoadProfile.h"
 
 #if	UE_VERSION_OLDER_THAN(5,1,0)
 #else
@@ -40,6 +44,8 @@
 #include "Animation/AnimSequence.h"
 #include "Animation/AnimBlueprint.h"
 #include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter.h"
+#include "HAL/PlatformTime.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -144,6 +150,20 @@ namespace {
 
 
 	TArray<FString> addedList;
+
+	struct FVertexInfluence {
+		FBoneIndexType InfluenceBones[MAX_TOTAL_INFLUENCES];
+		VRM4U_BONE_INFLUENCE_TYPE InfluenceWeights[MAX_TOTAL_INFLUENCES];
+	};
+
+	// bone weight of one mesh. gathered in parallel
+	struct FMeshWeightData {
+		TArray<int> activeBones;
+		TArray<int> bonemap;
+		TArray<BoneMapOpt> boneAll;
+		TArray<FVertexInfluence> influence;
+		FVrmSkinWeightStat skinStat;
+	};
 }
 
 static const aiNode* GetBoneNodeFromMeshID(const int &meshID, const aiNode *node) {
@@ -607,6 +627,260 @@ static void CreateSwingHead(UVrmAssetListObject *vrmAssetList, VRM::VRMSpring &s
 	}
 }
 
+#if WITH_EDITOR || UE_VERSION_OLDER_THAN(4,25,0)
+#else
+namespace {
+	// runtime LOD1.. from simplified LOD0 sections. morph deltas are remapped in ConvertMorphTarget
+	void GenerateRuntimeLOD(USkeletalMesh* sk, const aiScene* aiData, FReturnedData& result, const TArray<FSoftSkinVertexLocal>& Weight, const TArray<FSoftSkinVertexLocal>& Source, const TArray<uint32>& Triangles, int uvNum) {
+		const int32 lodNum = VRMConverter::Options::Get().GetRuntimeLODNum();
+#if	UE_VERSION_OLDER_THAN(5,2,0)
+#else
+		const bool bBoneWeight8Bit = VRMConverter::Options::Get().IsBoneWeight8Bit();
+#endif
+		FSkeletalMeshRenderData* renderData = sk->GetResourceForRendering();
+		if (lodNum <= 0 || renderData == nullptr || renderData->LODRenderData.Num() != 1 || Source.Num() != Weight.Num()) {
+			return;
+		}
+		const double StartTime = FPlatformTime::Seconds();
+
+		const FSkeletalMeshLODRenderData& rd0 = renderData->LODRenderData[0];
+		const int32 sectionNum = rd0.RenderSections.Num();
+
+		// options are thread local
+		TArray<float> lodRatio;
+		TArray<float> lodScreenSize;
+		for (int32 lod = 1; lod <= lodNum; ++lod) {
+			lodRatio.Add(VRMConverter::Options::Get().GetRuntimeLODTriangleRatio(lod));
+			lodScreenSize.Add(VRMConverter::Options::Get().GetRuntimeLODScreenSize(lod));
+		}
+		// skin weight difference cost. 1: same as moving the vertex by the edge length
+		const float SkinWeightScale = 1.f;
+
+		// morph target vertices are never removed
+		TArray<bool> lock;
+		lock.Init(false, Weight.Num());
+		{
+			int32 base = 0;
+			for (int meshID = 0; meshID < result.meshInfo.Num() && meshID < (int)aiData->mNumMeshes; ++meshID) {
+				const aiMesh* aiM = aiData->mMeshes[meshID];
+				const auto& mInfo = result.meshInfo[meshID];
+				const bool bUseFlag = mInfo.vertexUseFlag.Num() > 0;
+
+				int32 vertexNo = 0;
+				for (uint32 i = 0; i < aiM->mNumVertices && aiM->mNumAnimMeshes > 0; ++i) {
+					if (bUseFlag && (mInfo.vertexUseFlag.IsValidIndex(i) == false || mInfo.vertexUseFlag[i] == false)) {
+						continue;
+					}
+					const int32 v = base + vertexNo++;
+					if (vertexNo > mInfo.Vertices.Num() || lock.IsValidIndex(v) == false) {
+						break;
+					}
+					for (uint32 a = 0; a < aiM->mNumAnimMeshes; ++a) {
+						const aiAnimMesh* aiA = aiM->mAnimMeshes[a];
+						if (aiA == nullptr || aiA->mVertices == nullptr || i >= aiA->mNumVertices) {
+							continue;
+						}
+						if ((aiA->mVertices[i] - aiM->mVertices[i]).SquareLength() > 0.f) {
+							lock[v] = true;
+							break;
+						}
+					}
+				}
+				base += mInfo.Vertices.Num();
+			}
+		}
+
+		// section -> LOD -> section local indices. each LOD is simplified from the previous one
+		TArray<TArray<TArray<uint32>>> lodIndices;
+		TArray<float> lodError;
+		lodIndices.SetNum(sectionNum);
+		lodError.SetNumZeroed(sectionNum);
+		ParallelFor(sectionNum, [&](int32 sectionNo) {
+			const auto& sec = rd0.RenderSections[sectionNo];
+			const int32 baseVertex = sec.BaseVertexIndex;
+			const int32 vertexNum = sec.NumVertices;
+			lodIndices[sectionNo].SetNum(lodNum);
+
+			FVrmSimplifyMesh mesh;
+			mesh.InfluenceNum = MAX_TOTAL_INFLUENCES;
+			mesh.Position.SetNumUninitialized(vertexNum * 3);
+			mesh.SkinBone.SetNumUninitialized(vertexNum * MAX_TOTAL_INFLUENCES);
+			mesh.SkinWeight.SetNumUninitialized(vertexNum * MAX_TOTAL_INFLUENCES);
+			mesh.Lock.SetNumUninitialized(vertexNum);
+			for (int32 v = 0; v < vertexNum; ++v) {
+				const auto& w = Weight[baseVertex + v];
+				mesh.Position[v * 3 + 0] = w.Position.X;
+				mesh.Position[v * 3 + 1] = w.Position.Y;
+				mesh.Position[v * 3 + 2] = w.Position.Z;
+				for (int32 i = 0; i < MAX_TOTAL_INFLUENCES; ++i) {
+					mesh.SkinBone[v * MAX_TOTAL_INFLUENCES + i] = w.InfluenceBones[i];
+					mesh.SkinWeight[v * MAX_TOTAL_INFLUENCES + i] = w.InfluenceWeights[i] * VRM4U_InvMaxRawBoneWeightFloat;
+				}
+				mesh.Lock[v] = lock[baseVertex + v];
+			}
+
+			TArray<uint32> indices;
+			indices.SetNumUninitialized(sec.NumTriangles * 3);
+			for (int32 i = 0; i < indices.Num(); ++i) {
+				indices[i] = Triangles[sec.BaseIndex + i] - baseVertex;
+			}
+
+			for (int32 lod = 0; lod < lodNum; ++lod) {
+				const int32 target = FMath::Max(FMath::CeilToInt(sec.NumTriangles * lodRatio[lod]), 1);
+				const auto& src = (lod == 0) ? indices : lodIndices[sectionNo][lod - 1];
+				const float e = FVrmMeshSimplify::Simplify(mesh, src, target, SkinWeightScale, lodIndices[sectionNo][lod]);
+				lodError[sectionNo] = FMath::Max(lodError[sectionNo], e);
+			}
+		});
+
+		FVrmLoadProfile* profile = FVrmLoadProfileScope::Get();
+		if (profile) {
+			profile->LODTriangleNum.Reset();
+			profile->LODTriangleNum.Add(Triangles.Num() / 3);
+		}
+
+		result.LODVertexRemap.SetNum(lodNum);
+		for (int32 lod = 0; lod < lodNum; ++lod) {
+			auto& remap = result.LODVertexRemap[lod];
+			remap.Init(INDEX_NONE, Weight.Num());
+
+			// LOD vertex -> LOD0 vertex. LOD0 order is kept for the vertex fetch
+			TArray<int32> vertexList;
+			TArray<uint32> indices;
+
+			FSkeletalMeshLODRenderData* lodRd = new FSkeletalMeshLODRenderData();
+			renderData->LODRenderData.Add(lodRd);
+
+			lodRd->RequiredBones = rd0.RequiredBones;
+			lodRd->ActiveBoneIndices = rd0.ActiveBoneIndices;
+			lodRd->RenderSections.SetNum(sectionNum);
+
+			for (int32 sectionNo = 0; sectionNo < sectionNum; ++sectionNo) {
+				const auto& sec0 = rd0.RenderSections[sectionNo];
+				const auto& src = lodIndices[sectionNo][lod];
+				const int32 baseVertex = vertexList.Num();
+
+				TArray<int32> localIndex;
+				localIndex.Init(INDEX_NONE, sec0.NumVertices);
+				for (uint32 i : src) {
+					localIndex[i] = 0;
+				}
+				for (int32 v = 0; v < localIndex.Num(); ++v) {
+					if (localIndex[v] == INDEX_NONE) {
+						continue;
+					}
+					localIndex[v] = vertexList.Num();
+					remap[sec0.BaseVertexIndex + v] = vertexList.Num();
+					vertexList.Add(sec0.BaseVertexIndex + v);
+				}
+
+				FSkelMeshRenderSection& sec = lodRd->RenderSections[sectionNo];
+				sec.MaterialIndex = sec0.MaterialIndex;
+				sec.BaseIndex = indices.Num();
+				sec.NumTriangles = src.Num() / 3;
+				sec.bCastShadow = sec0.bCastShadow;
+				sec.BaseVertexIndex = baseVertex;
+				sec.NumVertices = vertexList.Num() - baseVertex;
+				sec.BoneMap = sec0.BoneMap;
+				sec.MaxBoneInfluences = sec0.MaxBoneInfluences;
+				TMap<int32, TArray<int32>> OverlappingVertices;
+				sec.DuplicatedVerticesBuffer.Init(sec.NumVertices, OverlappingVertices);
+				sec.bDisabled = (sec.NumTriangles == 0);
+
+				for (uint32 i : src) {
+					indices.Add(localIndex[i]);
+				}
+			}
+
+			const int32 vertexNum = vertexList.Num();
+			auto& vb = lodRd->StaticVertexBuffers;
+			vb.PositionVertexBuffer.Init(vertexNum);
+			// vertex colors of LOD0 through the remap, same as UVs
+			const auto& color0 = rd0.StaticVertexBuffers.ColorVertexBuffer;
+			const bool bColor = color0.GetAllocatedSize() > 0 && (int32)color0.GetNumVertices() == Weight.Num();
+			if (bColor) {
+				vb.ColorVertexBuffer.Init(vertexNum);
+			} else {
+				vb.ColorVertexBuffer.InitFromSingleColor(FColor(255, 255, 255, 255), vertexNum);
+			}
+			vb.StaticMeshVertexBuffer.Init(vertexNum, uvNum);
+
+			TArray<FSkinWeightInfo> InWeights;
+			InWeights.SetNum(vertexNum);
+			int elem = 0;
+			{
+				elem = std::extent<decltype(Weight[0].InfluenceBones)>::value;
+				FSkinWeightInfo info = {};
+				elem = FMath::Min(elem, (int)std::extent<decltype(info.InfluenceBones)>::value);
+			}
+
+			for (int32 i = 0; i < vertexNum; ++i) {
+				const auto& s = Source[vertexList[i]];
+				const auto& w = Weight[vertexList[i]];
+
+				vb.PositionVertexBuffer.VertexPosition(i) = w.Position;
+				vb.StaticMeshVertexBuffer.SetVertexTangents(i, s.TangentX, s.TangentY, s.TangentZ);
+				for (int u = 0; u < uvNum; ++u) {
+					vb.StaticMeshVertexBuffer.SetVertexUV(i, u, s.UVs[u]);
+				}
+				if (bColor) {
+					vb.ColorVertexBuffer.VertexColor(i) = color0.VertexColor(vertexList[i]);
+				}
+
+				FSkinWeightInfo info = {};
+				for (int al = 0; al < elem; ++al) {
+					// uint8 <> uint16
+					info.InfluenceBones[al] = w.InfluenceBones[al];
+					info.InfluenceWeights[al] = w.InfluenceWeights[al];
+				}
+				InWeights[i] = info;
+			}
+#if	UE_VERSION_OLDER_THAN(5,2,0)
+#else
+			// same precision as the skin weight stage
+			lodRd->SkinWeightVertexBuffer.SetUse16BitBoneWeight(bBoneWeight8Bit == false);
+#endif
+			lodRd->SkinWeightVertexBuffer = InWeights;
+
+			lodRd->MultiSizeIndexContainer.RebuildIndexBuffer(sizeof(uint32), indices);
+#if	UE_VERSION_OLDER_THAN(5,0,0)
+			lodRd->AdjacencyMultiSizeIndexContainer.RebuildIndexBuffer(sizeof(uint32), indices);
+#endif
+
+			{
+				FSkeletalMeshLODInfo& info = sk->AddLODInfo();
+				info.ScreenSize.Default = lodScreenSize[lod];
+			}
+
+#if	UE_VERSION_OLDER_THAN(5,4,0)
+			lodRd->InitResources(false, lod + 1, VRMGetMorphTargets(sk), sk);
+#else
+			{
+				TArray<UMorphTarget*> dummy;
+				for (auto& a : VRMGetMorphTargets(sk)) {
+					dummy.Add(a);
+				}
+				lodRd->InitResources(false, lod + 1, dummy, sk);
+			}
+#endif
+
+			UE_LOG(LogVRM4ULoader, Log, TEXT("runtime LOD%d :: %d triangles (%.1f%%)  %d vertices  screen size %.3f"),
+				lod + 1, indices.Num() / 3, Triangles.Num() ? 100.f * indices.Num() / Triangles.Num() : 0.f, vertexNum, lodScreenSize[lod]);
+			if (profile) {
+				profile->LODTriangleNum.Add(indices.Num() / 3);
+			}
+		}
+
+		float maxError = 0.f;
+		for (float e : lodError) {
+			maxError = FMath::Max(maxError, e);
+		}
+		UE_LOG(LogVRM4ULoader, Log, TEXT("runtime LOD :: max error %.4f  %.3f ms"), maxError, (FPlatformTime::Seconds() - StartTime) * 1000.0);
+		FVrmLoadProfileScope::AddStage(TEXT("GenerateLOD"), FPlatformTime::Seconds() - StartTime);
+	}
+}
+#endif
+
 bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 	if (vrmAssetList == nullptr) {
 		return false;
@@ -628,6 +902,20 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 	if (aiData->HasMeshes() && VRMConverter::Options::Get().IsDebugNoMesh() == false)
 	{
 
+		// !! before FindMesh. vertex id of the scene is changed !!
+		// vertex cache / fetch order
+		//
+		if (Options::Get().IsOptimizeVertexCache()) {
+			FVrmMeshOptimizeStat stat;
+			FVrmMeshOptimize::OptimizeScene(const_cast<aiScene*>(aiData), Options::Get().IsOptimizeOverdraw(), stat);
+
+			UE_LOG(LogVRM4ULoader, Log, TEXT("OptimizeVertexCache :: %lld triangles. ACMR %.3f -> %.3f"), stat.TriangleNum, stat.GetACMRBefore(), stat.GetACMRAfter());
+			if (FVrmLoadProfile* p = FVrmLoadProfileScope::Get()) {
+				p->ACMRBefore = stat.GetACMRBefore();
+				p->ACMRAfter = stat.GetACMRAfter();
+			}
+		}
+
 		// !! before remove unused vertex !!
 		// remove degenerate triangles
 		//
@@ -1008,87 +1296,168 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 			}
 			else {
 				auto& info = vrmAssetList->MeshReturnedData->meshInfo;
-				struct WeightData {
-					FString boneName;
-					float weight = 0;
-				};
-				TMap<int, TArray<WeightData> > weightTable;
 				auto* scene = const_cast<aiScene*>(aiData);
 
+				// one skinning matrix per bone. bind pose -> t pose
+				TMap<FString, int32> boneIndexTable;
+				TArray<FMatrix> boneMatrix;
+				TArray<bool> boneValid;
+
+				// weights of each vertex as (bone index, weight). CSR layout
+				TArray<int32> weightStart;
+				TArray<int32> weightBone;
+				TArray<float> weightValue;
+
 				// generate weightTable
 				{
+					int totalVertex = 0;
+					for (uint32_t meshNo = 0; meshNo < scene->mNumMeshes; ++meshNo) {
+						totalVertex += scene->mMeshes[meshNo]->mNumVertices;
+					}
+					weightStart.SetNumZeroed(totalVertex + 1);
+
+					// count
 					int vertexOffset = 0;
 					for (uint32_t meshNo = 0; meshNo < scene->mNumMeshes; ++meshNo) {
 						auto* mesh = scene->mMeshes[meshNo];
 						for (uint32_t boneNo = 0; boneNo < mesh->mNumBones; ++boneNo) {
 							auto* bone = mesh->mBones[boneNo];
+
+							const FString boneName = UTF8_TO_TCHAR(bone->mName.C_Str());
+							if (boneIndexTable.Find(boneName) == nullptr) {
+								auto tpose = vrmAssetList->Pose_tpose.Find(boneName);
+								auto bpose = vrmAssetList->Pose_bind.Find(boneName);
+
+								boneIndexTable.Add(boneName, boneMatrix.Num());
+								if (tpose && bpose) {
+									boneMatrix.Add((bpose->Inverse() * *tpose).ToMatrixWithScale());
+									boneValid.Add(true);
+								} else {
+									UE_LOG(LogVRM4ULoader, Warning, TEXT("BindPose -> TPose :: no pose transform %s %p %p"), *boneName, tpose, bpose);
+									boneMatrix.Add(FMatrix::Identity);
+									boneValid.Add(false);
+								}
+							}
+
+							for (uint32_t weightNo = 0; weightNo < bone->mNumWeights; ++weightNo) {
+								const uint32_t id = bone->mWeights[weightNo].mVertexId;
+								if (id < mesh->mNumVertices) {
+									++weightStart[vertexOffset + id + 1];
+								}
+							}
+						}
+						vertexOffset += mesh->mNumVertices;
+					}
+					for (int i = 0; i < totalVertex; ++i) {
+						weightStart[i + 1] += weightStart[i];
+					}
+					weightBone.SetNumUninitialized(weightStart[totalVertex]);
+					weightValue.SetNumUninitialized(weightStart[totalVertex]);
+
+					// fill. same order as bone / weight list
+					TArray<int32> fillPos;
+					fillPos.SetNumUninitialized(totalVertex);
+					for (int i = 0; i < totalVertex; ++i) {
+						fillPos[i] = weightStart[i];
+					}
+					vertexOffset = 0;
+					for (uint32_t meshNo = 0; meshNo < scene->mNumMeshes; ++meshNo) {
+						auto* mesh = scene->mMeshes[meshNo];
+						for (uint32_t boneNo = 0; boneNo < mesh->mNumBones; ++boneNo) {
+							auto* bone = mesh->mBones[boneNo];
+							const int32 boneIndex = boneIndexTable.FindChecked(UTF8_TO_TCHAR(bone->mName.C_Str()));
+
 							for (uint32_t weightNo = 0; weightNo < bone->mNumWeights; ++weightNo) {
 								auto weight = bone->mWeights[weightNo];
-
-								WeightData d;
-								d.boneName = UTF8_TO_TCHAR(bone->mName.C_Str());
-								d.weight = weight.mWeight;
-								weightTable.FindOrAdd(vertexOffset + weight.mVertexId).Add(d);
+								if (weight.mVertexId >= mesh->mNumVertices) {
+									continue;
+								}
+								const int32 pos = fillPos[vertexOffset + weight.mVertexId]++;
+								weightBone[pos] = boneIndex;
+								weightValue[pos] = weight.mWeight;
 							}
 						}
 						vertexOffset += mesh->mNumVertices;
 					}
+
 					// weight check
-					for (auto w : weightTable) {
+					int badWeightCount = 0;
+					for (int i = 0; i < totalVertex; ++i) {
+						if (weightStart[i] == weightStart[i + 1]) {
+							continue;
+						}
 						float f = 0.f;
-						for (auto data : w.Value) {
-							f += data.weight;
+						for (int w = weightStart[i]; w < weightStart[i + 1]; ++w) {
+							f += weightValue[w];
 						}
 						if (fabs(f - 1.f) > 0.01f) {
-							UE_LOG(LogVRM4ULoader, Warning, TEXT("BindPose -> TPose :: bad weight!"));
+							++badWeightCount;
 						}
 					}
+					if (badWeightCount) {
+						UE_LOG(LogVRM4ULoader, Warning, TEXT("BindPose -> TPose :: bad weight! %d vertices"), badWeightCount);
+					}
 				}// end weightTable
 
 				// bind pose -> t pose
 				{
+					FThreadSafeCounter noWeightCount;
+					FThreadSafeCounter badResultCount;
+
 					int vertexOffset = 0;
 					for (uint32_t meshNo = 0; meshNo < scene->mNumMeshes; ++meshNo) {
 						if (info.IsValidIndex(meshNo) == false) {
 							break;
 						}
 						auto* mesh = scene->mMeshes[meshNo];
+						auto& vertices = info[meshNo].Vertices;
+						const int vertexNum = FMath::Min<int>(vertices.Num(), mesh->mNumVertices);
+
+						// blocks of vertices. each vertex is independent
+						const int blockSize = 1024;
+						const int blockNum = (vertexNum + blockSize - 1) / blockSize;
+						ParallelFor(blockNum, [&](int32 blockNo) {
+							const int vertexBegin = blockNo * blockSize;
+							const int vertexEnd = FMath::Min(vertexBegin + blockSize, vertexNum);
+
+							for (int vertexNo = vertexBegin; vertexNo < vertexEnd; ++vertexNo) {
+								const int index = vertexOffset + vertexNo;
+								if (weightStart[index] == weightStart[index + 1]) {
+									noWeightCount.Increment();
+									continue;
+								}
 
-						for (int vertexNo = 0; vertexNo < info[meshNo].Vertices.Num(); ++vertexNo) {
-							FVector v_orig = info[meshNo].Vertices[vertexNo];
-							//v_orig.Set(mesh->mVertices[vertexNo].x, mesh->mVertices[vertexNo].y, mesh->mVertices[vertexNo].z);
-							v_orig.Set(mesh->mVertices[vertexNo].x, -mesh->mVertices[vertexNo].z, mesh->mVertices[vertexNo].y);
-							FVector v(0, 0, 0);
-
-							if (weightTable.Find(vertexOffset + vertexNo) == nullptr) {
-								UE_LOG(LogVRM4ULoader, Warning, TEXT("BindPose -> TPose :: no weight data %d"), vertexOffset + vertexNo);
-								continue;
-							}
-							for (auto a : weightTable[vertexOffset + vertexNo]) {
-								auto tpose = vrmAssetList->Pose_tpose.Find(a.boneName);
-								auto bpose = vrmAssetList->Pose_bind.Find(a.boneName);
+								const FVector v_orig(mesh->mVertices[vertexNo].x * 100.f, -mesh->mVertices[vertexNo].z * 100.f, mesh->mVertices[vertexNo].y * 100.f);
+								FVector v(0, 0, 0);
 
-								if (tpose && bpose) {
-									FVector v_diff = (bpose->Inverse() * *tpose).TransformPosition(v_orig * 100.f);
-									v += v_diff * a.weight;
+								for (int w = weightStart[index]; w < weightStart[index + 1]; ++w) {
+									const int32 b = weightBone[w];
+									if (boneValid[b] == false) {
+										continue;
+									}
+									v += boneMatrix[b].TransformPosition(v_orig) * weightValue[w];
+								}
 #if	UE_VERSION_OLDER_THAN(5,1,0)
-									float len = v.Size();
+								float len = v.Size();
 #else
-									float len = v.Length();
+								float len = v.Length();
 #endif
-									if (len >= 100000) {
-										UE_LOG(LogVRM4ULoader, Warning, TEXT("BindPose -> TPose :: bad weight!"));
-									}
-								}
-								else {
-									UE_LOG(LogVRM4ULoader, Warning, TEXT("BindPose -> TPose :: no pose transform %p %p"), tpose, bpose);
+								if (len >= 100000) {
+									badResultCount.Increment();
 								}
+								v.Set(v.X, v.Z, -v.Y);
+								vertices[vertexNo] = v / 100.f;
 							}
-							v.Set(v.X, v.Z, -v.Y);
-							info[meshNo].Vertices[vertexNo] = v / 100.f;
-						}
+						});
 						vertexOffset += mesh->mNumVertices;
 					}
+
+					if (noWeightCount.GetValue()) {
+						UE_LOG(LogVRM4ULoader, Warning, TEXT("BindPose -> TPose :: no weight data %d vertices"), noWeightCount.GetValue());
+					}
+					if (badResultCount.GetValue()) {
+						UE_LOG(LogVRM4ULoader, Warning, TEXT("BindPose -> TPose :: bad weight! %d vertices"), badResultCount.GetValue());
+					}
 				}
 			}
 		}// end bind -> t pose
@@ -1209,6 +1578,14 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 			TArray<uint32> Triangles;
 			TArray<FSoftSkinVertexLocal> Weight;
 			Weight.SetNum(allVertex);
+
+			// all attributes of LOD0 vertices. source of runtime LOD
+			TArray<FSoftSkinVertexLocal> lodSourceVertex;
+#if WITH_EDITOR || UE_VERSION_OLDER_THAN(4,25,0)
+			const bool bRuntimeLOD = false;
+#else
+			const bool bRuntimeLOD = (VRMConverter::IsImportMode() == false) && Options::Get().GetRuntimeLODNum() > 0;
+#endif
 			for (auto &w : Weight) {
 				w = softSkinVertexLocalZero;
 			}
@@ -1233,6 +1610,176 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 				rd.RenderSections.Empty();
 				rd.RenderSections.SetNum(result.meshInfo.Num());
 			}
+
+			// skeleton bone index of each aiBone / mesh node. one lookup per bone name
+			TArray<TArray<int32>> meshBoneTable;
+			TArray<int32> meshNodeBone;
+			// render section fallback. index in the skeleton, as before
+			TArray<int32> meshNodeSkeletonBone;
+			{
+				TMap<FString, int32> boneNameTable;
+				auto findBone = [&](const aiString &name) {
+					const FString s = UTF8_TO_TCHAR(name.C_Str());
+					if (const int32 *p = boneNameTable.Find(s)) {
+						return *p;
+					}
+					const int32 b = VRMGetRefSkeleton(sk).FindBoneIndex(*s);
+					boneNameTable.Add(s, b);
+					return b;
+				};
+
+				meshBoneTable.SetNum(result.meshInfo.Num());
+				meshNodeBone.SetNum(result.meshInfo.Num());
+				meshNodeSkeletonBone.SetNum(result.meshInfo.Num());
+				for (int meshID = 0; meshID < result.meshInfo.Num(); ++meshID) {
+					const auto &aiM = aiData->mMeshes[meshID];
+					meshBoneTable[meshID].SetNum(aiM->mNumBones);
+					for (uint32 boneIndex = 0; boneIndex < aiM->mNumBones; ++boneIndex) {
+						meshBoneTable[meshID][boneIndex] = findBone(aiM->mBones[boneIndex]->mName);
+					}
+					const auto *p = GetNodeFromMeshID(meshID, aiData);
+					meshNodeBone[meshID] = p ? findBone(p->mName) : INDEX_NONE;
+					meshNodeSkeletonBone[meshID] = p ? k->GetReferenceSkeleton().FindBoneIndex(UTF8_TO_TCHAR(p->mName.C_Str())) : INDEX_NONE;
+				}
+			}
+
+			// gather bone weight of each mesh in parallel
+			TArray<FMeshWeightData> meshWeightData;
+			meshWeightData.SetNum(result.meshInfo.Num());
+			{
+				TArray<int> meshVertexBase;
+				meshVertexBase.SetNum(result.meshInfo.Num());
+				for (int meshID = 0, base = 0; meshID < result.meshInfo.Num(); ++meshID) {
+					meshVertexBase[meshID] = base;
+					base += result.meshInfo[meshID].Vertices.Num();
+				}
+
+				// options are thread local
+				const bool bDebugOneBone = Options::Get().IsDebugOneBone();
+				const bool bMobileBone = Options::Get().IsMobileBone();
+
+				FVrmSkinWeightParam skinParam;
+				skinParam.InfluenceNum = Options::Get().GetBoneWeightInfluenceNum();
+				skinParam.PruneThreshold = Options::Get().GetBoneWeightPruneThreshold();
+				skinParam.OutputMax = VRM4U_MaxBoneWeight;
+				skinParam.QuantizeBits = (VRM4U_MaxBoneWeight > 255 && Options::Get().IsBoneWeight8Bit() == false) ? 16 : 8;
+
+				ParallelFor(result.meshInfo.Num(), [&](int32 meshID) {
+					const auto &aiM = aiData->mMeshes[meshID];
+					const auto &boneTable = meshBoneTable[meshID];
+					const int vertexBase = meshVertexBase[meshID];
+
+					auto &gather = meshWeightData[meshID];
+					{
+						FVertexInfluence zero;
+						memset(&zero, 0, sizeof(zero));
+						gather.influence.Init(zero, result.meshInfo[meshID].Vertices.Num());
+					}
+
+					auto isValidWeight = [&](const aiVertexWeight &aiW) {
+						if (aiW.mWeight == 0.f) {
+							return false;
+						}
+						if (Weight.IsValidIndex(aiW.mVertexId + vertexBase) == false || gather.influence.IsValidIndex(aiW.mVertexId) == false) {
+							return false;
+						}
+						return FMath::Clamp(aiW.mWeight, 0.f, 1.f) >= VRM4U_BoneWeightThreshold;
+					};
+
+					// used bones
+					for (uint32 boneIndex = 0; boneIndex < aiM->mNumBones; ++boneIndex) {
+						const auto &aiB = aiM->mBones[boneIndex];
+						const int b = boneTable[boneIndex];
+						if (b < 0) {
+							continue;
+						}
+						for (uint32 weightIndex = 0; weightIndex < aiB->mNumWeights; ++weightIndex) {
+							if (isValidWeight(aiB->mWeights[weightIndex])) {
+								gather.activeBones.AddUnique(b);
+								break;
+							}
+						}
+					}
+					gather.bonemap = gather.activeBones;
+					gather.bonemap.Sort();
+
+					// all influences of each vertex. reduced in the skin weight stage
+					TArray<FVrmSkinWeight::FVertex> rawWeight;
+					rawWeight.SetNum(gather.influence.Num());
+
+					for (uint32 boneIndex = 0; boneIndex < aiM->mNumBones; ++boneIndex) {
+						const auto &aiB = aiM->mBones[boneIndex];
+						const int b = boneTable[boneIndex];
+						if (b < 0) {
+							continue;
+						}
+
+						int tabledIndex = gather.bonemap.Find(b);
+						if (tabledIndex == INDEX_NONE) {
+							// no valid weight
+							continue;
+						}
+						if (tabledIndex > 255) {
+							UE_LOG(LogVRM4ULoader, Warning, TEXT("bonemap over!"));
+						}
+						if (bDebugOneBone) {
+							tabledIndex = 0;
+						}
+
+						for (uint32 weightIndex = 0; weightIndex < aiB->mNumWeights; ++weightIndex) {
+							const auto &aiW = aiB->mWeights[weightIndex];
+							if (isValidWeight(aiW) == false) {
+								continue;
+							}
+							const float ww = FMath::Clamp(aiW.mWeight, 0.f, 1.f);
+
+							rawWeight[aiW.mVertexId].Add(tabledIndex, ww);
+
+							if (bMobileBone) {
+								auto p = gather.boneAll.FindByPredicate([&](BoneMapOpt &o) {return o.boneIndex == b; });
+								if (p) {
+									p->weight += aiW.mWeight;
+								} else {
+									BoneMapOpt o;
+									o.boneIndex = b;
+									o.weight = aiW.mWeight;
+									gather.boneAll.Add(o);
+								}
+							}
+						}
+					}
+
+					// skin weight stage. top K, prune, renormalize, quantize
+					const int32 outNum = FMath::Min<int32>(FVrmSkinWeight::GetInfluenceNum(skinParam.InfluenceNum), MAX_TOTAL_INFLUENCES);
+					for (int i = 0; i < gather.influence.Num(); ++i) {
+						int32 bone[MAX_TOTAL_INFLUENCES] = {};
+						int32 weight[MAX_TOTAL_INFLUENCES] = {};
+						if (rawWeight[i].Num == 0) {
+							continue;
+						}
+						FVrmSkinWeight::Process(rawWeight[i], skinParam, bone, weight, outNum, gather.skinStat);
+
+						auto &s = gather.influence[i];
+						for (int jj = 0; jj < MAX_TOTAL_INFLUENCES; ++jj) {
+							s.InfluenceBones[jj] = (FBoneIndexType)bone[jj];
+							s.InfluenceWeights[jj] = (VRM4U_BONE_INFLUENCE_TYPE)weight[jj];
+						}
+					}
+				});
+
+				FVrmSkinWeightStat skinStat;
+				for (const auto &gather : meshWeightData) {
+					skinStat.Add(gather.skinStat);
+				}
+				UE_LOG(LogVRM4ULoader, Log, TEXT("BoneWeight :: %lld vertices. K=%d  reduced %lld  pruned %lld  unnormalized %lld  error mean %.5f max %.5f"),
+					skinStat.VertexNum, skinParam.InfluenceNum, skinStat.ReducedVertexNum, skinStat.PrunedNum, skinStat.UnnormalizedVertexNum,
+					skinStat.GetErrorMean(), skinStat.ErrorMax);
+				if (FVrmLoadProfile* p = FVrmLoadProfileScope::Get()) {
+					p->BoneWeightErrorMean = skinStat.GetErrorMean();
+					p->BoneWeightErrorMax = skinStat.ErrorMax;
+				}
+			}
+
 			for (int meshID = 0; meshID < result.meshInfo.Num(); ++meshID) {
 				TArray<FSoftSkinVertexLocal> meshWeight;
 				auto &mInfo = result.meshInfo[meshID];
@@ -1311,117 +1858,26 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 				} // vertex loop
 
 				auto &aiM = aiData->mMeshes[meshID];
-				TArray<int> bonemap;
-				TArray<BoneMapOpt> boneAll;
-				/* skip! no first bone
-				{
-					bonemap.Add(0);
-					BoneMapOpt o;
-					o.boneIndex = 0;
-					o.weight = -1.f;
-					boneAll.Add(o);
-				}
-				*/
-				//aiData->mRootNode->mMeshes
-				for (uint32 boneIndex = 0; boneIndex < aiM->mNumBones; ++boneIndex) {
-					auto& aiB = aiM->mBones[boneIndex];
-
-					const int b = VRMGetRefSkeleton(sk).FindBoneIndex(UTF8_TO_TCHAR(aiB->mName.C_Str()));
-
-					if (b < 0) {
-						continue;
-					}
-					for (uint32 weightIndex = 0; weightIndex < aiB->mNumWeights; ++weightIndex) {
-						auto& aiW = aiB->mWeights[weightIndex];
-
-						if (aiW.mWeight == 0.f) {
-							continue;
-						}
-						for (int jj = 0; jj < MAX_TOTAL_INFLUENCES; ++jj) {
-							if (Weight.IsValidIndex(aiW.mVertexId + currentVertex) == false) {
-								continue;
-							}
-							auto& s = Weight[aiW.mVertexId + currentVertex];
-							if (s.InfluenceWeights[jj] > 0) {
-								continue;
-							}
-
-							const float ww = FMath::Clamp(aiW.mWeight, 0.f, 1.f);
-							if (ww < VRM4U_BoneWeightThreshold) {
-								continue;
-							}
+				auto &gather = meshWeightData[meshID];
+				TArray<int> &bonemap = gather.bonemap;
+				TArray<BoneMapOpt> &boneAll = gather.boneAll;
 
-							bonemap.AddUnique(b);
-							AllActiveBones.AddUnique(b);
-						}
-					}
+				for (auto b : gather.activeBones) {
+					AllActiveBones.AddUnique(b);
 				}
-				bonemap.Sort();
-
-
-				for (uint32 boneIndex = 0; boneIndex < aiM->mNumBones; ++boneIndex) {
-					auto &aiB = aiM->mBones[boneIndex];
-
-					const int b = VRMGetRefSkeleton(sk).FindBoneIndex(UTF8_TO_TCHAR(aiB->mName.C_Str()));
-
-					if (b < 0) {
-						continue;
-					}
-					for (uint32 weightIndex = 0; weightIndex < aiB->mNumWeights; ++weightIndex) {
-						auto &aiW = aiB->mWeights[weightIndex];
-
-						if (aiW.mWeight == 0.f) {
+				for (int i = 0; i < gather.influence.Num(); ++i) {
+					const auto &inf = gather.influence[i];
+					for (int jj = 0; jj < MAX_TOTAL_INFLUENCES; ++jj) {
+						if (inf.InfluenceWeights[jj] == 0) {
 							continue;
 						}
-						for (int jj = 0; jj < MAX_TOTAL_INFLUENCES; ++jj) {
-							if (Weight.IsValidIndex(aiW.mVertexId + currentVertex) == false) {
-								continue;
-							}
-							auto &s = Weight[aiW.mVertexId + currentVertex];
-							if (s.InfluenceWeights[jj] > 0) {
-								continue;
-							}
-
-							const float ww = FMath::Clamp(aiW.mWeight, 0.f, 1.f);
-							if (ww < VRM4U_BoneWeightThreshold) {
-								continue;
-							}
-
-							int tabledIndex = bonemap.AddUnique(b);
-							if (tabledIndex == INDEX_NONE) {
-								UE_LOG(LogVRM4ULoader, Warning, TEXT("bonemap add error!"));
-								tabledIndex = 0;
-							}
-
-							if (tabledIndex > 255) {
-								UE_LOG(LogVRM4ULoader, Warning, TEXT("bonemap over!"));
-							}
-
-							if (Options::Get().IsDebugOneBone()) {
-								tabledIndex = 0;
-							}
-
-							s.InfluenceBones[jj] = tabledIndex;
-							//s.InfluenceWeights[jj] = (VRM4U_BONE_INFLUENCT_TYPE)FMath::TruncToInt(ww * 255.f + (0.5f - KINDA_SMALL_NUMBER));
-							s.InfluenceWeights[jj] = (VRM4U_BONE_INFLUENCE_TYPE)FMath::TruncToInt(ww * VRM4U_MaxBoneWeightFloat);
-
-							meshWeight[aiW.mVertexId].InfluenceBones[jj] = s.InfluenceBones[jj];
-							meshWeight[aiW.mVertexId].InfluenceWeights[jj] = s.InfluenceWeights[jj];
-
-							if (Options::Get().IsMobileBone()){
-								auto p = boneAll.FindByPredicate([&](BoneMapOpt &o) {return o.boneIndex == b; });
-								if (p) {
-									p->weight += aiW.mWeight;
-								} else {
-									BoneMapOpt o;
-									o.boneIndex = b;
-									o.weight = aiW.mWeight;
-									boneAll.Add(o);
-								}
-							}
-
-							break;
+						if (Weight.IsValidIndex(currentVertex + i)) {
+							auto &s = Weight[currentVertex + i];
+							s.InfluenceBones[jj] = inf.InfluenceBones[jj];
+							s.InfluenceWeights[jj] = inf.InfluenceWeights[jj];
 						}
+						meshWeight[i].InfluenceBones[jj] = inf.InfluenceBones[jj];
+						meshWeight[i].InfluenceWeights[jj] = inf.InfluenceWeights[jj];
 					}
 				}// bone loop
 
@@ -1503,98 +1959,76 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 				}// mobile remap
 
 				// normalize weight
-				for (auto& w : meshWeight) {
-					static int warnCount = 0;
-					if (&w == &meshWeight[0]) {
-						warnCount = 0;
-					}
-
-					// sort by Weight
-					for (int i = 0; i < MAX_TOTAL_INFLUENCES - 1; ++i) {
-						for (int j = i + 1; j < MAX_TOTAL_INFLUENCES; ++j) {
-							if (w.InfluenceWeights[i] < w.InfluenceWeights[j]) {
-								std::swap(w.InfluenceWeights[i], w.InfluenceWeights[j]);
-								std::swap(w.InfluenceBones[i], w.InfluenceBones[j]);
+				{
+					// vertex without weight is bound to the mesh node
+					int noWeightInf = 0;
+					for (const auto &w : meshWeight) {
+						int f = 0;
+						for (int i = 0; i < MAX_TOTAL_INFLUENCES; ++i) {
+							f += w.InfluenceWeights[i];
+						}
+						if (f != 0) {
+							continue;
+						}
+						int dummy = 0;
+						if (GetNodeFromMeshID(meshID, aiData)) {
+							dummy = meshNodeBone[meshID];
+							if (dummy == INDEX_NONE) {
+								dummy = 0;
 							}
+							// add active bone for simple static mesh (not skinned mesh)
+							AllActiveBones.AddUnique(dummy);
+						}
+						noWeightInf = bonemap.AddUnique(dummy);
+						if (noWeightInf == INDEX_NONE) {
+							noWeightInf = 0;
 						}
+						break;
 					}
 
-					int f = 0;
-					int maxIndex = 0;
-					int maxWeight = 0;
-					for (int i = 0; i < MAX_TOTAL_INFLUENCES; ++i) {
-						f += w.InfluenceWeights[i];
+					// weights are sorted, reduced and quantized in the skin weight stage.
+					// no weight vertices, and weights dropped by the mobile remap
+					const int blockSize = 1024;
+					const int blockNum = (meshWeight.Num() + blockSize - 1) / blockSize;
+					ParallelFor(blockNum, [&](int32 blockNo) {
+						const int vertexBegin = blockNo * blockSize;
+						const int vertexEnd = FMath::Min(vertexBegin + blockSize, meshWeight.Num());
 
-						if (maxWeight < w.InfluenceWeights[i]) {
-							maxWeight = w.InfluenceWeights[i];
-							maxIndex = i;
-						}
-					}
-					if (f > VRM4U_MaxBoneWeight) {
-						UE_LOG(LogVRM4ULoader, Warning, TEXT("overr"));
-						w.InfluenceWeights[0] -= (VRM4U_BONE_INFLUENCE_TYPE)(f - VRM4U_MaxBoneWeight);
-					}
-					if (1) {
-						if (f <= (VRM4U_MaxBoneWeight - MAX_TOTAL_INFLUENCES)) {
-							if (warnCount < 50) {
-								UE_LOG(LogVRM4ULoader, Warning, TEXT("less"));
-								warnCount++;
-							}
-						}
-						if (f == 0) {
-							auto* p = GetNodeFromMeshID(meshID, aiData);
+						for (int vertexNo = vertexBegin; vertexNo < vertexEnd; ++vertexNo) {
+							auto &w = meshWeight[vertexNo];
 
-							int dummy = 0;
-							if (p) {
-								dummy = VRMGetRefSkeleton(sk).FindBoneIndex(UTF8_TO_TCHAR(p->mName.C_Str()));
-								if (dummy == INDEX_NONE) {
-									dummy = 0;
+							int f = 0;
+							int maxIndex = 0;
+							for (int i = 0; i < MAX_TOTAL_INFLUENCES; ++i) {
+								f += w.InfluenceWeights[i];
+								if (w.InfluenceWeights[maxIndex] < w.InfluenceWeights[i]) {
+									maxIndex = i;
 								}
-								// add active bone for simple static mesh (not skinned mesh)
-								AllActiveBones.AddUnique(dummy);
 							}
-
-							auto inf = bonemap.AddUnique(dummy);
-							if (inf == INDEX_NONE) {
-								inf = 0;
+							if (f == 0) {
+								w.InfluenceBones[0] = noWeightInf;
+								w.InfluenceWeights[0] = (VRM4U_BONE_INFLUENCE_TYPE)VRM4U_MaxBoneWeight;
+								continue;
 							}
-							w.InfluenceBones[0] = inf;
-							w.InfluenceWeights[0] += (VRM4U_BONE_INFLUENCE_TYPE)(VRM4U_MaxBoneWeight - f);
-
-						} else {
-							const int n = Options::Get().GetBoneWeightInfluenceNum();
-
-							{
-								// recalc weight
-								f = 0;
-								for (int i = 0; i < n; ++i) {
-									f += w.InfluenceWeights[i];
-								}
-								if (f == 0) {
-									f = 1;
-								}
-								for (int i = n; i < MAX_TOTAL_INFLUENCES; ++i) {
-									w.InfluenceBones[i] = 0;
-									w.InfluenceWeights[i] = 0;
-								}
-
-								int total = 0;
+							if (f < VRM4U_MaxBoneWeight) {
+								// scale the rest proportionally. rounding remainder goes to the largest
+								int sum = 0;
 								for (int i = 0; i < MAX_TOTAL_INFLUENCES; ++i) {
-									int t = w.InfluenceWeights[i];
-									w.InfluenceWeights[i] = (VRM4U_BONE_INFLUENCE_TYPE)FMath::TruncToInt(VRM4U_MaxBoneWeightFloat * t / f);
-									total += w.InfluenceWeights[i];
-								}
-								// adjust
-								if (total > VRM4U_MaxBoneWeight) {
-									UE_LOG(LogVRM4ULoader, Warning, TEXT("overr"));
-									w.InfluenceWeights[0] -= (VRM4U_BONE_INFLUENCE_TYPE)(total - VRM4U_MaxBoneWeight);
+									const int nw = (int)((int64)w.InfluenceWeights[i] * VRM4U_MaxBoneWeight / f);
+									w.InfluenceWeights[i] = (VRM4U_BONE_INFLUENCE_TYPE)nw;
+									sum += nw;
 								}
-								w.InfluenceWeights[0] += (VRM4U_BONE_INFLUENCE_TYPE)(VRM4U_MaxBoneWeight - total);
+								w.InfluenceWeights[maxIndex] += (VRM4U_BONE_INFLUENCE_TYPE)(VRM4U_MaxBoneWeight - sum);
 							}
 						}
-					}
+					});
 				}// nomalize weight
 
+				if (bRuntimeLOD) {
+					lodSourceVertex.Append(meshWeight);
+				}
+
+
 				if (VRMConverter::IsImportMode() == false) {
 			
 					FSkelMeshRenderSection &NewRenderSection = rd.RenderSections[meshID];
@@ -1628,8 +2062,7 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 						}
 					}else {
 						NewRenderSection.BoneMap.SetNum(1);
-						auto *p = GetNodeFromMeshID(meshID, aiData);
-						int32 i = k->GetReferenceSkeleton().FindBoneIndex(UTF8_TO_TCHAR(p->mName.C_Str()));
+						int32 i = meshNodeSkeletonBone[meshID];
 						if (i <= 0) {
 							i = meshID;
 						}
@@ -1686,8 +2119,7 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 						}
 					}else {
 						s.BoneMap.SetNum(1);
-						auto *p = GetNodeFromMeshID(meshID, aiData);
-						int32 i = k->GetReferenceSkeleton().FindBoneIndex(UTF8_TO_TCHAR(p->mName.C_Str()));
+						int32 i = meshNodeSkeletonBone[meshID];
 						if (i <= 0) {
 							i = meshID;
 						}
@@ -1780,16 +2212,6 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 					int maxIndex = 0;
 					int maxWeight = 0;
 
-#if	UE_VERSION_OLDER_THAN(5,2,0)
-#else
-#if WITH_EDITOR
-#else
-					for (int i = 0; i < Options::Get().GetBoneWeightInfluenceNum(); ++i) {
-						w.InfluenceWeights[i] = (VRM4U_BONE_INFLUENCE_TYPE)(((int)(w.InfluenceWeights[i] / 256)) * 256);
-					}
-#endif
-#endif
-
 					for (int i = 0; i < MAX_TOTAL_INFLUENCES; ++i) {
 						f += w.InfluenceWeights[i];
 
@@ -1855,6 +2277,11 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 				}
 
 				pRd->ReleaseResources();
+#if	UE_VERSION_OLDER_THAN(5,2,0)
+#else
+				// weights are quantized by the skin weight stage. 8 bit storage keeps the high byte, which is exact for 8 bit quantization
+				pRd->SkinWeightVertexBuffer.SetUse16BitBoneWeight(Options::Get().IsBoneWeight8Bit() == false);
+#endif
 				pRd->SkinWeightVertexBuffer = InWeights;
 #if	UE_VERSION_OLDER_THAN(5,4,0)
 				pRd->InitResources(false, 0, VRMGetMorphTargets(sk), sk);
@@ -1868,6 +2295,10 @@ bool VRMConverter::ConvertModel(UVrmAssetListObject *vrmAssetList) {
 				}
 #endif // 5.4
 			}
+
+			if (bRuntimeLOD) {
+				GenerateRuntimeLOD(sk, aiData, result, Weight, lodSourceVertex, Triangles, uvNum);
+			}
 #endif // 4.25
 
 #endif // editor
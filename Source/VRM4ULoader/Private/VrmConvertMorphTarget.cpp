@@ -19,6 +19,12 @@
 #include "PhysicsEngine/PhysicsConstraintTemplate.h"
 
 #include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+#if	UE_VERSION_OLDER_THAN(4,23,0)
+#define TRACE_CPUPROFILER_EVENT_SCOPE(a)
+#else
+#endif
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -33,12 +39,13 @@ namespace {
 	{
 		Morph->PopulateDeltas(Deltas, LODIndex, Sections);
 	}
-#else
+#endif
+	// render sections of LODIndex. game build, and runtime LOD in all builds
 	void LocalPopulateDeltas(USkeletalMesh* sk, UMorphTarget * Morph, const TArray<FMorphTargetDelta> & Deltas, const int32 LODIndex, const bool bCompareNormal = false, const bool bGeneratedByReductionSetting = false, const float PositionThreshold = THRESH_POINTS_ARE_NEAR)
 	{
 
 		//TIndirectArray<FSkeletalMeshLODRenderData> LODRenderData;
-		const auto& Sections = sk->GetResourceForRendering()->LODRenderData[0].RenderSections;
+		const auto& Sections = sk->GetResourceForRendering()->LODRenderData[LODIndex].RenderSections;
 
 		//FSkeletalMeshLODRenderData& rd = sk->GetResourceForRendering()->LODRenderData[0];
 
@@ -123,143 +130,237 @@ namespace {
 		MorphModel.NumVertices = MorphModel.Vertices.Num();
 #endif
 }
-#endif
 
 }
 
-static bool readMorph2(TArray<FMorphTargetDelta> &MorphDeltas, aiString targetName,const aiScene *aiData, const UVrmAssetListObject *assetList) {
-
-	MorphDeltas.Reset(0);
-	uint32_t currentVertex = 0;
+namespace {
+	// case sensitive. same as aiString compare
+	struct FMorphNameKeyFuncs : TDefaultMapKeyFuncs<FString, int32, false> {
+		static FORCEINLINE bool Matches(const FString& A, const FString& B) {
+			return A.Equals(B, ESearchCase::CaseSensitive);
+		}
+		static FORCEINLINE uint32 GetKeyHash(const FString& Key) {
+			return FCrc::StrCrc32(*Key);
+		}
+	};
+
+	struct FMorphSource {
+		uint32 MeshIndex;
+		uint32 AnimMeshIndex;
+	};
+
+	// loop invariant values. read only from worker threads
+	struct FMorphReadParam {
+		const aiScene* aiData = nullptr;
+		const UVrmAssetListObject* assetList = nullptr;
+
+		// first vertex of each mesh in the merged vertex buffer
+		TArray<uint32> MeshVertexBase;
+
+		FTransform RootTransform;
+		float ModelScale = 1.f;
+		bool bIncludeNormal = false;
+		bool bVRM10 = false;
+
+		// position delta = Axis[0] * d.x + Axis[1] * d.y + Axis[2] * d.z
+		// axis swap, cm, root rotation and model scale in one 3x3
+		FVector Axis[3];
+
+		void InitAxis() {
+			const FVector e[3] = {
+				bVRM10 ? FVector(100.f, 0, 0) : FVector(-100.f, 0, 0),
+				FVector(0, 0, 100.f),
+				bVRM10 ? FVector(0, -100.f, 0) : FVector(0, 100.f, 0),
+			};
+			for (int i = 0; i < 3; ++i) {
+				Axis[i] = RootTransform.TransformVector(e[i]) * ModelScale;
+			}
+		}
+	};
 
-	FMorphTargetDelta morphinit;
 #if	UE_VERSION_OLDER_THAN(5,0,0)
-	morphinit.PositionDelta = FVector::ZeroVector;
-	morphinit.SourceIdx = 0;
-	morphinit.TangentZDelta = FVector::ZeroVector;
+	typedef VectorRegister VRMVectorRegister;
+	FORCEINLINE VRMVectorRegister VRMVectorZero() { return VectorZero(); }
 #else
-	morphinit.PositionDelta = FVector3f::ZeroVector;
-	morphinit.SourceIdx = 0;
-	morphinit.TangentZDelta = FVector3f::ZeroVector;
+	typedef VectorRegister4Float VRMVectorRegister;
+	FORCEINLINE VRMVectorRegister VRMVectorZero() { return VectorZeroFloat(); }
 #endif
 
-	for (uint32_t m = 0; m < aiData->mNumMeshes; ++m) {
-		const auto &mesh = assetList->MeshReturnedData->meshInfo[m];
+	// position only. deltas of all used vertices are written, zero ones are overwritten by the next
+	int32 ReadMorphPositionSIMD(FMorphTargetDelta* Out, const aiMesh& aiM, const aiAnimMesh& aiA, uint32_t NumVertices, const TArray<bool>& UseFlag, uint32_t currentVertex, const FMorphReadParam& param) {
+		const VRMVectorRegister c0 = MakeVectorRegister((float)param.Axis[0].X, (float)param.Axis[0].Y, (float)param.Axis[0].Z, 0.f);
+		const VRMVectorRegister c1 = MakeVectorRegister((float)param.Axis[1].X, (float)param.Axis[1].Y, (float)param.Axis[1].Z, 0.f);
+		const VRMVectorRegister c2 = MakeVectorRegister((float)param.Axis[2].X, (float)param.Axis[2].Y, (float)param.Axis[2].Z, 0.f);
+		const VRMVectorRegister zero = VRMVectorZero();
 
-		const aiMesh &aiM = *(aiData->mMeshes[m]);
+		const bool bUseFlag = UseFlag.Num() > 0;
+		const aiVector3D* pA = aiA.mVertices;
+		const aiVector3D* pM = aiM.mVertices;
 
-		for (uint32_t a = 0; a < aiM.mNumAnimMeshes; ++a) {
-			const aiAnimMesh &aiA = *(aiM.mAnimMeshes[a]);
-			if (targetName != aiA.mName) {
+		FMorphTargetDelta* p = Out;
+		uint32_t VertexCount = 0;
+
+		for (uint32_t i = 0; i < NumVertices; ++i) {
+			if (bUseFlag && UseFlag[i] == false) {
 				continue;
 			}
+			const uint32_t SourceIdx = currentVertex + VertexCount;
+			++VertexCount;
 
-			if (aiM.mNumVertices != aiA.mNumVertices) {
-				UE_LOG(LogVRM4ULoader, Warning, TEXT("test18.\n"));
-			}
+			const VRMVectorRegister d = VectorSubtract(VectorLoadFloat3(&pA[i].x), VectorLoadFloat3(&pM[i].x));
+			VRMVectorRegister r = VectorMultiply(VectorReplicate(d, 0), c0);
+			r = VectorMultiplyAdd(VectorReplicate(d, 1), c1, r);
+			r = VectorMultiplyAdd(VectorReplicate(d, 2), c2, r);
 
-			TArray<FMorphTargetDelta> tmpData;
-			tmpData.Reserve(aiA.mNumVertices);
+			VectorStoreFloat3(r, &p->PositionDelta.X);
+#if	UE_VERSION_OLDER_THAN(5,0,0)
+			p->TangentZDelta = FVector::ZeroVector;
+#else
+			p->TangentZDelta = FVector3f::ZeroVector;
+#endif
+			p->SourceIdx = SourceIdx;
 
-			bool bIncludeNormal = VRMConverter::Options::Get().IsEnableMorphTargetNormal();
+			// keep when any of xyz is non zero
+			p += (VectorMaskBits(VectorCompareNE(r, zero)) & 0x7) ? 1 : 0;
+		}
+		return (int32)(p - Out);
+	}
+}
 
-			int VertexCount = 0;
+static bool readMorph2(TArray<FMorphTargetDelta> &MorphDeltas, int32 &OutSourceVertexNum, const TArray<FMorphSource> &SourceList, const FMorphReadParam &param) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM readMorph2"))
 
-			for (uint32_t i = 0; i < aiA.mNumVertices; ++i) {
+	MorphDeltas.Reset(0);
+	OutSourceVertexNum = 0;
 
-				if (mesh.vertexUseFlag.Num() > 0) {
-					if (mesh.vertexUseFlag[i] == false) {
-						continue;
-					}
+	const aiScene* aiData = param.aiData;
+	const bool bIncludeNormal = param.bIncludeNormal;
+	const bool bVRM10 = param.bVRM10;
+
+	for (const auto &src : SourceList) {
+		const uint32_t m = src.MeshIndex;
+		const auto &mesh = param.assetList->MeshReturnedData->meshInfo[m];
+
+		const aiMesh &aiM = *(aiData->mMeshes[m]);
+		const aiAnimMesh &aiA = *(aiM.mAnimMeshes[src.AnimMeshIndex]);
+
+		if (aiM.mNumVertices != aiA.mNumVertices) {
+			UE_LOG(LogVRM4ULoader, Warning, TEXT("test18.\n"));
+		}
+
+		const uint32_t currentVertex = param.MeshVertexBase[m];
+		const bool bUseFlag = mesh.vertexUseFlag.Num() > 0;
+		const uint32_t NumVertices = FMath::Min(aiA.mNumVertices, aiM.mNumVertices);
+
+		if (bUseFlag) {
+			OutSourceVertexNum += mesh.useVertexCount;
+		} else {
+			OutSourceVertexNum += NumVertices;
+		}
+
+		if (bIncludeNormal == false) {
+			if (aiA.mVertices == nullptr || aiM.mVertices == nullptr) {
+				// no position, no normal. all zero
+				continue;
+			}
+			// compact into reserved slack, then grow Num to the survivors. no realloc
+			const int32 base = MorphDeltas.Num();
+			MorphDeltas.Reserve(base + NumVertices);
+			const int32 num = ReadMorphPositionSIMD(MorphDeltas.GetData() + base, aiM, aiA, NumVertices, mesh.vertexUseFlag, currentVertex, param);
+			MorphDeltas.SetNumUninitialized(base + num);
+			continue;
+		}
+
+		MorphDeltas.Reserve(MorphDeltas.Num() + NumVertices);
+
+		int VertexCount = 0;
+
+		for (uint32_t i = 0; i < NumVertices; ++i) {
+
+			if (bUseFlag) {
+				if (mesh.vertexUseFlag[i] == false) {
+					continue;
 				}
+			}
 
 #if	UE_VERSION_OLDER_THAN(5,0,0)
-				FMorphTargetDelta v = { FVector::ZeroVector, FVector::ZeroVector, 0 };
+			FMorphTargetDelta v = { FVector::ZeroVector, FVector::ZeroVector, 0 };
 #else
-				FMorphTargetDelta v = { FVector3f::ZeroVector, FVector3f::ZeroVector, 0 };
+			FMorphTargetDelta v = { FVector3f::ZeroVector, FVector3f::ZeroVector, 0 };
 #endif
-				v.SourceIdx = VertexCount + currentVertex;
-				++VertexCount;
+			v.SourceIdx = VertexCount + currentVertex;
+			++VertexCount;
 
-				if (aiA.mVertices) {
+			if (aiA.mVertices) {
 
-					auto aiV = aiA.mVertices[i] - aiM.mVertices[i];
+				auto aiV = aiA.mVertices[i] - aiM.mVertices[i];
 
+				if (bVRM10) {
+					v.PositionDelta.Set(
+						aiV[0] * 100.f,
+						-aiV[2] * 100.f,
+						aiV[1] * 100.f
+					);
+				} else {
 					v.PositionDelta.Set(
 						-aiV[0] * 100.f,
 						aiV[2] * 100.f,
 						aiV[1] * 100.f
 					);
-
-					if (VRMConverter::Options::Get().IsVRM10Model()) {
-						v.PositionDelta.Set(
-							aiV[0] * 100.f,
-							-aiV[2] * 100.f,
-							aiV[1] * 100.f
-						);
-					}
-
-					// apply original root bone rotation
-					FVector tmp;
-					tmp.Set(v.PositionDelta.X, v.PositionDelta.Y, v.PositionDelta.Z);
-					tmp = assetList->model_root_transform.TransformVector(tmp);
-					v.PositionDelta.Set(tmp.X, tmp.Y, tmp.Z);
 				}
 
-				v.PositionDelta *= VRMConverter::Options::Get().GetModelScale();
+				// apply original root bone rotation
+				FVector tmp;
+				tmp.Set(v.PositionDelta.X, v.PositionDelta.Y, v.PositionDelta.Z);
+				tmp = param.RootTransform.TransformVector(tmp);
+				v.PositionDelta.Set(tmp.X, tmp.Y, tmp.Z);
+			}
+
+			v.PositionDelta *= param.ModelScale;
 
 
-				if (bIncludeNormal) {
+			if (bIncludeNormal) {
 
-					auto aiV = aiA.mNormals[i] - aiM.mNormals[i];
+				auto aiV = aiA.mNormals[i] - aiM.mNormals[i];
 
 #if	UE_VERSION_OLDER_THAN(5,0,0)
-					FVector n(
+				FVector n(
 #else
-					FVector3f n(
+				FVector3f n(
 #endif
-						-aiV[0],
-						aiV[2],
+					-aiV[0],
+					aiV[2],
+					aiV[1]);
+
+				if (bVRM10) {
+					n.Set(
+						aiV[0],
+						-aiV[2],
 						aiV[1]);
-
-					if (VRMConverter::Options::Get().IsVRM10Model()) {
-						n.Set(
-							aiV[0],
-							-aiV[2],
-							aiV[1]);
-					}
-
-					if (n.Size() > 1.f) {
-						v.TangentZDelta = n.GetUnsafeNormal();
-					}
-
-					if (VRMConverter::Options::Get().IsVRM10Model()) {
-						v.TangentZDelta.X *= -1.f;
-						v.TangentZDelta.Y *= -1.f;
-					}
 				}
 
-				// skip invalid vertex data
-				if (v.PositionDelta.Size() == 0) {
-					if (bIncludeNormal == false) {
-						continue;
-					}
-					if (v.TangentZDelta.Size() == 0) {
-						continue;
-					}
+				if (n.Size() > 1.f) {
+					v.TangentZDelta = n.GetUnsafeNormal();
 				}
 
-				tmpData.Add(v);
-			} // vertex loop
+				if (bVRM10) {
+					v.TangentZDelta.X *= -1.f;
+					v.TangentZDelta.Y *= -1.f;
+				}
+			}
 
+			// skip invalid vertex data
+			if (v.PositionDelta.Size() == 0) {
+				if (bIncludeNormal == false) {
+					continue;
+				}
+				if (v.TangentZDelta.Size() == 0) {
+					continue;
+				}
+			}
 
-			MorphDeltas.Append(tmpData);
-		}
-		if (mesh.vertexUseFlag.Num() > 0) {
-			currentVertex += mesh.useVertexCount;
-		}else{
-			currentVertex += aiM.mNumVertices;
-		}
+			MorphDeltas.Add(v);
+		} // vertex loop
 	}
 	return MorphDeltas.Num() != 0;
 }
@@ -277,32 +378,79 @@ bool VRMConverter::ConvertMorphTarget(UVrmAssetListObject *vrmAssetList) {
 	USkeletalMesh *sk = vrmAssetList->SkeletalMesh;
 
 	TArray<FString> MorphNameList;
-	TArray<FString> MorphNameList_Strict;
 	TArray<UMorphTarget*> MorphTargetList;
 
+	FMorphReadParam param;
+	param.aiData = aiData;
+	param.assetList = vrmAssetList;
+	param.RootTransform = vrmAssetList->model_root_transform;
+	param.ModelScale = Options::Get().GetModelScale();
+	param.bIncludeNormal = Options::Get().IsEnableMorphTargetNormal();
+	param.bVRM10 = Options::Get().IsVRM10Model();
+	param.InitAxis();
+	const bool bForceOriginalName = Options::Get().IsForceOriginalMorphTargetName();
+
+	// name -> (mesh, animMesh) index. built once instead of a scene walk per morph
+	TMap<FString, int32, FDefaultSetAllocator, FMorphNameKeyFuncs> SourceIndexMap;
+	TArray<TArray<FMorphSource>> SourceTable;
+	{
+		uint32_t currentVertex = 0;
+		param.MeshVertexBase.SetNum(aiData->mNumMeshes);
+		for (uint32_t m = 0; m < aiData->mNumMeshes; ++m) {
+			const aiMesh &aiM = *(aiData->mMeshes[m]);
+			const auto &mesh = vrmAssetList->MeshReturnedData->meshInfo[m];
+
+			param.MeshVertexBase[m] = currentVertex;
+			if (mesh.vertexUseFlag.Num() > 0) {
+				currentVertex += mesh.useVertexCount;
+			}else{
+				currentVertex += aiM.mNumVertices;
+			}
+
+			for (uint32_t a = 0; a < aiM.mNumAnimMeshes; ++a) {
+				const FString name = UTF8_TO_TCHAR(aiM.mAnimMeshes[a]->mName.C_Str());
+				int32* idx = SourceIndexMap.Find(name);
+				if (idx == nullptr) {
+					idx = &SourceIndexMap.Add(name, SourceTable.Num());
+					SourceTable.AddDefaulted();
+				}
+				SourceTable[*idx].Add({ m, a });
+			}
+		}
+	}
+
+	// morphs to build. name resolution is order dependent, keep it serial
+	struct FMorphJob {
+		FString Name;
+		int32 SourceIndex;
+	};
+	TArray<FMorphJob> JobList;
+
+	// lookup for MorphNameList / original names
+	TSet<FString> MorphNameSet;
+	TSet<FString> MorphNameSet_Strict;
+
 	for (uint32_t m = 0; m < aiData->mNumMeshes; ++m) {
 		const aiMesh &aiM = *(aiData->mMeshes[m]);
 		for (uint32_t a = 0; a < aiM.mNumAnimMeshes; ++a) {
 			const aiAnimMesh &aiA = *(aiM.mAnimMeshes[a]);
-			//aiA.
-			TArray<FMorphTargetDelta> MorphDeltas;
 
 			FString morphName = UTF8_TO_TCHAR(aiA.mName.C_Str());
 			FString morphNameOrg = morphName;
-			if (VRMConverter::Options::Get().IsForceOriginalMorphTargetName()) {
+			if (bForceOriginalName) {
 			}else{
 				morphName = VRMUtil::MakeName(morphName);
 				//morphName = VRMConverter::NormalizeFileName(morphName);
 
 				if (morphName != morphNameOrg) {
-					if (MorphNameList_Strict.Find(morphNameOrg) == INDEX_NONE) {
+					if (MorphNameSet_Strict.Contains(morphNameOrg) == false) {
 
 						auto tmp = morphName;
 						int i = 0;
 						if (VRMUtil::IsNoSafeName(morphName)) {
 							tmp = TEXT("UE5EA_patch_") + morphName + TEXT("_") + FString::FromInt(i);
 						}
-						while (MorphNameList.Find(tmp) != INDEX_NONE) {
+						while (MorphNameSet.Contains(tmp)) {
 							++i;
 							tmp = TEXT("UE5EA_patch_") + morphName + TEXT("_") + FString::FromInt(i);
 						}
@@ -315,18 +463,57 @@ bool VRMConverter::ConvertMorphTarget(UVrmAssetListObject *vrmAssetList) {
 			}
 
 
-			if (MorphNameList.Find(morphName) != INDEX_NONE) {
+			if (MorphNameSet.Contains(morphName)) {
 				continue;
 			}
 
 			MorphNameList.Add(morphName);
-			MorphNameList_Strict.Add(morphNameOrg);
-			if (readMorph2(MorphDeltas, aiA.mName, aiData, vrmAssetList) == false) {
+			MorphNameSet.Add(morphName);
+			MorphNameSet_Strict.Add(morphNameOrg);
+			JobList.Add({ morphName, SourceIndexMap.FindChecked(morphNameOrg) });
+		}
+	}
+
+	// deltas of each morph in parallel
+	TArray<TArray<FMorphTargetDelta>> DeltaList;
+	TArray<int32> SourceVertexNumList;
+	TArray<double> TimeList;
+	DeltaList.SetNum(JobList.Num());
+	SourceVertexNumList.SetNumZeroed(JobList.Num());
+	TimeList.SetNumZeroed(JobList.Num());
+	ParallelFor(JobList.Num(), [&](int32 i) {
+		const double t = FPlatformTime::Seconds();
+		readMorph2(DeltaList[i], SourceVertexNumList[i], SourceTable[JobList[i].SourceIndex], param);
+		TimeList[i] = FPlatformTime::Seconds() - t;
+	});
+
+	{
+		// sparsity and time of each morph
+		int64 deltaTotal = 0;
+		int64 sourceTotal = 0;
+		double timeTotal = 0;
+		for (int32 i = 0; i < JobList.Num(); ++i) {
+			const int32 n = DeltaList[i].Num();
+			const int32 s = SourceVertexNumList[i];
+			UE_LOG(LogVRM4ULoader, Verbose, TEXT("VRM morph: %s  delta=%d/%d (%.1f%%)  %.3f ms"),
+				*JobList[i].Name, n, s, s ? 100.0 * n / s : 0.0, TimeList[i] * 1000.0);
+			deltaTotal += n;
+			sourceTotal += s;
+			timeTotal += TimeList[i];
+		}
+		UE_LOG(LogVRM4ULoader, Log, TEXT("VRM morph: %d targets  delta=%lld/%lld (%.1f%%)  %.3f ms (sum of workers)"),
+			JobList.Num(), deltaTotal, sourceTotal, sourceTotal ? 100.0 * deltaTotal / sourceTotal : 0.0, timeTotal * 1000.0);
+	}
+
+	{
+		for (int32 j = 0; j < JobList.Num(); ++j) {
+			TArray<FMorphTargetDelta> &MorphDeltas = DeltaList[j];
+			if (MorphDeltas.Num() == 0) {
 				continue;
 			}
 
 			//FString sss = FString::Printf(TEXT("%02d_%02d_"), m, a) + FString(aiA.mName.C_Str());
-			FString sss = morphName;// FString::Printf(TEXT("%02d_%02d_"), m, a) + FString();
+			FString sss = JobList[j].Name;// FString::Printf(TEXT("%02d_%02d_"), m, a) + FString();
 			UMorphTarget *mt = NewObject<UMorphTarget>(sk, *sss);
 
 #if WITH_EDITOR
@@ -353,9 +540,36 @@ bool VRMConverter::ConvertMorphTarget(UVrmAssetListObject *vrmAssetList) {
 
 					mt->BaseSkelMesh = sk;
 				}
+
+				// runtime LOD. same deltas on the vertices left in each LOD
+				const auto& LODVertexRemap = vrmAssetList->MeshReturnedData->LODVertexRemap;
+				for (int32 lod = 0; lod < LODVertexRemap.Num(); ++lod) {
+					const auto& remap = LODVertexRemap[lod];
+					TArray<FMorphTargetDelta> LODDeltas;
+					LODDeltas.Reserve(MorphDeltas.Num());
+					for (const auto& d : MorphDeltas) {
+						if (remap.IsValidIndex(d.SourceIdx) == false || remap[d.SourceIdx] == INDEX_NONE) {
+							continue;
+						}
+						FMorphTargetDelta tmp = d;
+						tmp.SourceIdx = remap[d.SourceIdx];
+						LODDeltas.Add(tmp);
+					}
+
+#if	UE_VERSION_OLDER_THAN(5,0,0)
+					auto& MorphLODModels = mt->MorphLODModels;
+#else
+					auto& MorphLODModels = mt->GetMorphLODModels();
+#endif
+					if (MorphLODModels.IsValidIndex(lod + 1)) {
+						MorphLODModels[lod + 1].Reset();
+					}
+					LocalPopulateDeltas(sk, mt, LODDeltas, lod + 1);
+				}
 #endif
 				MorphTargetList.Add(mt);
 			}
+			MorphDeltas.Empty();
 		}
 	}
 
@@ -440,26 +654,30 @@ bool VRMConverter::ConvertMorphTarget(UVrmAssetListObject *vrmAssetList) {
 	if (sk->GetResourceForRendering()) {
 		if (sk->GetResourceForRendering()->LODRenderData.Num() > 0) {
 
+			// LOD1.. are runtime LOD
+			auto& LODRenderData = sk->GetResourceForRendering()->LODRenderData;
+			for (int32 lod = 0; lod < LODRenderData.Num(); ++lod) {
 #if	UE_VERSION_OLDER_THAN(5,0,0)
 #else
-			if (VRMConverter::IsImportMode() == false) {
-				for (auto& RenderSection : sk->GetResourceForRendering()->LODRenderData[0].RenderSections) {
-					RenderSection.DuplicatedVerticesBuffer.DupVertData.SetNum(1);
+				if (VRMConverter::IsImportMode() == false) {
+					for (auto& RenderSection : LODRenderData[lod].RenderSections) {
+						RenderSection.DuplicatedVerticesBuffer.DupVertData.SetNum(1);
+					}
 				}
-			}
 #endif
 
 #if	UE_VERSION_OLDER_THAN(5,4,0)
-			sk->GetResourceForRendering()->LODRenderData[0].InitResources(false, 0, VRMGetMorphTargets(sk), sk);
+				LODRenderData[lod].InitResources(false, lod, VRMGetMorphTargets(sk), sk);
 #else
-			{
-				TArray<UMorphTarget*> morphtargets;
-				for (auto morphtarget : VRMGetMorphTargets(sk)) {
-					morphtargets.Add(morphtarget);
+				{
+					TArray<UMorphTarget*> morphtargets;
+					for (auto morphtarget : VRMGetMorphTargets(sk)) {
+						morphtargets.Add(morphtarget);
+					}
+					LODRenderData[lod].InitResources(false, lod, morphtargets, sk);
 				}
-				sk->GetResourceForRendering()->LODRenderData[0].InitResources(false, 0, morphtargets, sk);
-			}
 #endif
+			}
 		}
 	}
 #endif
@@ -3,6 +3,8 @@
 #include "VrmConvertTexture.h"
 #include "VrmConvert.h"
 #include "VrmUtil.h"
+#include "VrmTextureMip.h"
+#include "VrmTextureDedup.h"
 
 #include "Materials/MaterialExpressionTextureSampleParameter2D.h"
 
@@ -233,38 +235,7 @@ namespace {
 
 		// scale texture
 		{
-			ParallelFor(dH, [&](int32 y){
-			//for (int32 y = 0; y < dH; y++){
-				float s = (float)H / dH;
-
-				for (int32 x = 0; x < dW; x++){
-					int32 xx = (s * (0.5f + x));
-					int32 yy = (s * (0.5f + y));
-					uint8* dp = &dData[(y * dW + x) * sizeof(uint8) * 4];
-
-					int c = 0;
-					int tmp[4] = {};
-					int n = (float)W / dW / 2;
-					for (int ry = yy - n; ry <= yy + n; ry++) {
-						for (int rx = xx - n; rx <= xx + n; rx++) {
-							if (rx < 0 || ry < 0) continue;
-							if (rx >= W || ry >= H) continue;
-
-							const uint8* rp = &sData[(ry * W + rx) * sizeof(uint8) * 4];
-							tmp[0] += rp[0];
-							tmp[1] += rp[1];
-							tmp[2] += rp[2];
-							tmp[3] += rp[3];
-
-							++c;
-						}
-					}
-					dp[0] = tmp[0] / c;
-					dp[1] = tmp[1] / c;
-					dp[2] = tmp[2] / c;
-					dp[3] = tmp[3] / c;
-				}
-			});
+			FVrmTextureMip::ResizeBGRA(sData.GetData(), W, H, dData.GetData(), dW, dH, false);
 
 			// Set options
 			NewTexture2D->SRGB = true;// bUseSRGB;
@@ -705,7 +676,40 @@ bool VRMConverter::ConvertTextureAndMaterial(UVrmAssetListObject *vrmAssetList)
 			texArray.Reserve(aiData->mNumTextures);
 			// Note: PNG format.  Other formats are supported
 
+			const VRMLoaderUtil::FImageProcessParam processParam = VRMLoaderUtil::GetImageProcessParam(NormalBoolTable);
+
+			// same images. decoded once
+			FVrmTextureDedup dedup;
+			dedup.Init(aiData, processParam);
+			TArray<UTexture2D*> sharedTexture;
+			sharedTexture.SetNumZeroed(aiData->mNumTextures);
+			dedup.FindShared(sharedTexture);
+
+			// decode on worker threads, then create textures here
+			TArray<VRMUtil::FImportImage> imageList;
+			if (DecodedImageList && DecodedImageList->Num() == (int32)aiData->mNumTextures) {
+				imageList = MoveTemp(*DecodedImageList);
+			} else {
+				VRMLoaderUtil::DecodeSceneTextures(aiData, imageList, VRMConverter::Options::Get().IsLoadCache(), &dedup.SkipDecode);
+			}
+			VRMLoaderUtil::ProcessSceneImages(imageList, processParam);
+
 			for (uint32_t i = 0; i < aiData->mNumTextures; ++i) {
+				if (dedup.IsCreateTexture(i) == false) {
+					if (sharedTexture[i]) {
+						texArray.Push(sharedTexture[i]);
+						if (NormalBoolTable[i] == false && VRMConverter::Options::Get().IsBC7Mode()) {
+							textureCompressTypeArray.Add(EVRMImportTextureCompressType::VRMITC_BC7);
+						} else {
+							textureCompressTypeArray.Add(EVRMImportTextureCompressType::VRMITC_DXT1);
+						}
+					} else {
+						texArray.Push(texArray[dedup.Remap[i]]);
+						textureCompressTypeArray.Add(textureCompressTypeArray[dedup.Remap[i]]);
+					}
+					continue;
+				}
+
 				auto& t = *aiData->mTextures[i];
 				int Width = t.mWidth;
 				int Height = t.mHeight;
@@ -724,7 +728,8 @@ bool VRMConverter::ConvertTextureAndMaterial(UVrmAssetListObject *vrmAssetList)
 				if (VRMConverter::Options::Get().IsSingleUAssetFile() == false) {
 					pkg = VRM4U_CreatePackage(vrmAssetList->Package, *name);
 				}
-				UTexture2D* NewTexture2D = VRMLoaderUtil::CreateTextureFromImage(name, pkg, t.pcData, t.mWidth, bGenerateMips, NormalBoolTable[i], bNormalGreenFlip&&(VRMConverter::IsImportMode()==false));
+				UTexture2D* NewTexture2D = VRMLoaderUtil::CreateTextureFromDecodedImage(name, pkg, imageList[i], bGenerateMips, NormalBoolTable[i], bNormalGreenFlip&&(VRMConverter::IsImportMode()==false));
+				imageList[i] = VRMUtil::FImportImage();
 #if WITH_EDITOR
 				NewTexture2D->DeferCompression = false;
 #endif
@@ -771,6 +776,9 @@ bool VRMConverter::ConvertTextureAndMaterial(UVrmAssetListObject *vrmAssetList)
 #endif
 				}
 
+				if (dedup.bShare) {
+					FVrmTextureDedup::AddShared(dedup.Hash[i], NewTexture2D);
+				}
 				texArray.Push(NewTexture2D);
 			}
 			vrmAssetList->Textures = texArray;
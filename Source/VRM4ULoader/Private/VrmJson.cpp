@@ -2,112 +2,140 @@
 
 #include "VrmJson.h"
 
-bool VrmJson::init(const uint8_t* pData, size_t size) {
-	bEnable = false;
-
-	if (size < 4 || pData == nullptr) {
-		return false;
+namespace {
+	uint32_t LocalReadU32(const uint8_t* p) {
+		return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
 	}
+}
 
-	int c = 0;
-	size_t c_start = 0;
-	{
-		std::vector<char> str = { 'J','S','O','N' };
+bool VrmJson::GetGLBChunk(const uint8_t* pData, size_t size, const char*& json, size_t& jsonSize, const uint8_t*& bin, size_t& binSize) {
+	json = nullptr;
+	jsonSize = 0;
+	bin = nullptr;
+	binSize = 0;
 
-		for (; c_start < size - str.size(); ++c_start) {
-			bool bFound = false;
+	if (pData == nullptr || size < 12) {
+		return false;
+	}
 
-			for (int i = 0; i < 4; ++i) {
-				if (str[i] != pData[c_start + i]) {
-					continue;
-				}
-				bFound = true;
-			}
-			if (bFound) {
-				c_start += 4;
-				break;
-			}
+	// gltf (text)
+	if (memcmp(pData, "glTF", 4) != 0) {
+		size_t i = 0;
+		while (i < size && (pData[i] == ' ' || pData[i] == '\t' || pData[i] == '\r' || pData[i] == '\n')) {
+			++i;
+		}
+		if (i < size && pData[i] == '{') {
+			json = (const char*)pData;
+			jsonSize = size;
+			return true;
 		}
+		return false;
 	}
 
-	size_t c_end = c_start;
-	for (; c_end < size; ++c_end) {
-		if (pData[c_end] == '{') {
-			c++;
+	// header: magic, version, length
+	size_t total = LocalReadU32(pData + 8);
+	if (total > size) {
+		total = size;
+	}
+
+	// chunk: length, type, data
+	size_t pos = 12;
+	while (pos + 8 <= total) {
+		const size_t chunkSize = LocalReadU32(pData + pos);
+		const uint8_t* type = pData + pos + 4;
+		const uint8_t* data = pData + pos + 8;
+		if (chunkSize > total - pos - 8) {
+			break;
 		}
-		if (pData[c_end] == '}') {
-			c--;
+
+		if (memcmp(type, "JSON", 4) == 0 && json == nullptr) {
+			json = (const char*)data;
+			jsonSize = chunkSize;
 		}
-		if (c == 0) {
-			++c_end;
-			break;
+		if (memcmp(type, "BIN\0", 4) == 0 && bin == nullptr) {
+			bin = data;
+			binSize = chunkSize;
 		}
+		pos += 8 + chunkSize;
 	}
+	return json != nullptr;
+}
 
-	if (c_end - c_start <=1) {
+bool VrmJson::init(const uint8_t* pData, size_t size) {
+	bEnable = false;
+
+	const char* json = nullptr;
+	size_t jsonSize = 0;
+	const uint8_t* bin = nullptr;
+	size_t binSize = 0;
+	if (GetGLBChunk(pData, size, json, jsonSize, bin, binSize) == false) {
 		return false;
 	}
-	std::vector<char> v;
-	v.resize(c_end - c_start);
-	memcpy(&v[0], pData + c_start, c_end - c_start);
-	v.push_back(0);
-
-	doc.Parse(&v[0]);
 
-	bEnable = true;
-	return true;
+	return initJson(json, jsonSize);
 }
 
-bool VRMIsVRM10(const uint8_t* pData, size_t size) {
+bool VrmJson::initJson(const char* pJson, size_t size) {
+	bEnable = false;
 
-	if (size < 4 || pData == nullptr) {
+	if (size == 0 || pJson == nullptr) {
+		return false;
+	}
+	doc.Parse(pJson, size);
+	if (doc.HasParseError() || doc.IsObject() == false) {
 		return false;
 	}
 
-	int c = 0;
-	size_t c_start = 0;
-	{
-		std::vector<char> str = { 'J','S','O','N' };
-
-		for (; c_start < size - str.size(); ++c_start) {
-			bool bFound = false;
+	bEnable = true;
+	return true;
+}
 
-			for (int i = 0; i < 4; ++i) {
-				if (str[i] != pData[c_start + i]) {
-					continue;
-				}
-				bFound = true;
-			}
-			if (bFound) {
-				c_start += 4;
-				break;
-			}
-		}
+bool VrmJson::GetImageBufferView(int imageIndex, size_t& offset, size_t& length) const {
+	offset = 0;
+	length = 0;
+	if (bEnable == false || imageIndex < 0) {
+		return false;
 	}
-
-	size_t c_end = c_start;
-	for (; c_end < size; ++c_end) {
-		if (pData[c_end] == '{') {
-			c++;
-		}
-		if (pData[c_end] == '}') {
-			c--;
-		}
-		if (c == 0) {
-			++c_end;
-			break;
-		}
+	if (doc.HasMember("images") == false || doc.HasMember("bufferViews") == false) {
+		return false;
 	}
+	const auto& images = doc["images"];
+	if (images.IsArray() == false || imageIndex >= (int)images.Size()) {
+		return false;
+	}
+	const auto& image = images[imageIndex];
+	if (image.IsObject() == false || image.HasMember("bufferView") == false || image["bufferView"].IsInt() == false) {
+		return false;
+	}
+	const int bv = image["bufferView"].GetInt();
 
-	std::vector<char> v;
-	v.resize(c_end - c_start);
-	memcpy(&v[0], pData + c_start, c_end - c_start);
-	v.push_back(0);
-
-	RAPIDJSON_NAMESPACE::Document doc;
-	doc.Parse(&v[0]);
+	const auto& bufferViews = doc["bufferViews"];
+	if (bufferViews.IsArray() == false || bv < 0 || bv >= (int)bufferViews.Size()) {
+		return false;
+	}
+	const auto& view = bufferViews[bv];
+	if (view.IsObject() == false) {
+		return false;
+	}
+	// GLB BIN chunk is buffer 0. other buffers are external files
+	if (view.HasMember("buffer") == false || view["buffer"].IsUint() == false || view["buffer"].GetUint() != 0) {
+		return false;
+	}
+	if (view.HasMember("byteLength") == false || view["byteLength"].IsUint() == false) {
+		return false;
+	}
+	if (view.HasMember("byteOffset") && view["byteOffset"].IsUint()) {
+		offset = view["byteOffset"].GetUint();
+	}
+	length = view["byteLength"].GetUint();
+	return length > 0;
+}
 
-	if (doc.HasMember("extensions")) {
+bool VrmJson::IsVRM10() const {
+	if (bEnable == false) {
+		return false;
+	}
+	if (doc.HasMember("extensions") && doc["extensions"].IsObject()) {
 		if (doc["extensions"].HasMember("VRMC_vrm")) {
 			return true;
 		}
@@ -116,4 +144,35 @@ bool VRMIsVRM10(const uint8_t* pData, size_t size) {
 		}
 	}
 	return false;
-}
\ No newline at end of file
+}
+
+bool VrmJson::HasPrimitiveAttribute(const char* name) const {
+	if (bEnable == false) {
+		return false;
+	}
+	if (doc.HasMember("meshes") == false || doc["meshes"].IsArray() == false) {
+		return false;
+	}
+	for (const auto& mesh : doc["meshes"].GetArray()) {
+		if (mesh.IsObject() == false || mesh.HasMember("primitives") == false || mesh["primitives"].IsArray() == false) {
+			return false;
+		}
+		for (const auto& prim : mesh["primitives"].GetArray()) {
+			if (prim.IsObject() == false || prim.HasMember("attributes") == false || prim["attributes"].IsObject() == false) {
+				return false;
+			}
+			if (prim["attributes"].HasMember(name) == false) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+bool VRMIsVRM10(const uint8_t* pData, size_t size) {
+	VrmJson json;
+	if (json.init(pData, size) == false) {
+		return false;
+	}
+	return json.IsVRM10();
+}
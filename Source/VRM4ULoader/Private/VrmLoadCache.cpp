@@ -0,0 +1,296 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmLoadCache.h"
+#include "VRM4ULoaderLog.h"
+
+#include "HAL/FileManager.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/Paths.h"
+#include "Misc/Guid.h"
+#include "Hash/CityHash.h"
+#include "Serialization/Archive.h"
+#include "Templates/UniquePtr.h"
+
+#include <assimp/scene.h>
+
+#if	UE_VERSION_OLDER_THAN(4,23,0)
+#define TRACE_CPUPROFILER_EVENT_SCOPE(a)
+#else
+#endif
+
+namespace {
+	// bump when the file layout or the decoder output changes
+	const uint32 CacheMagic = 0x43524D56;	// 'VMRC'
+	const uint32 CacheVersion = 1;
+
+	const TCHAR* CacheExt = TEXT(".vrmcache");
+
+	FCriticalSection& GetCacheLock() {
+		static FCriticalSection cs;
+		return cs;
+	}
+
+	int64 CacheMaxSize = 512 * 1024 * 1024;
+
+	// largest texture size of the engine
+	const int32 CacheMaxImageSize = 16384;
+
+	// only decoder output is cached. BGRA8, uncompressed
+	bool IsCacheImageFormat(const VRMUtil::FImportImage& img) {
+		return img.Format == TSF_BGRA8 && img.PixelFormat == PF_B8G8R8A8;
+	}
+
+	// layout of a loaded entry matches its data. empty entries are skipped images
+	bool IsValidCacheImage(const VRMUtil::FImportImage& img, int64 size) {
+		if (size == 0 && img.SizeX == 0 && img.SizeY == 0) {
+			return true;
+		}
+		if (IsCacheImageFormat(img) == false) {
+			return false;
+		}
+		if (img.SizeX <= 0 || img.SizeY <= 0 || img.SizeX > CacheMaxImageSize || img.SizeY > CacheMaxImageSize) {
+			return false;
+		}
+		if (img.NumMips <= 0 || img.NumMips > (int32)FMath::CeilLogTwo(FMath::Max(img.SizeX, img.SizeY)) + 1) {
+			return false;
+		}
+		return size == img.GetMipOffset(img.NumMips);
+	}
+
+	uint64 HashBuffer(const void* p, uint64 size, uint64 seed) {
+		// CityHash64 takes 32bit length
+		const char* c = (const char*)p;
+		while (size > 0) {
+			const uint32 len = (uint32)FMath::Min<uint64>(size, MAX_uint32);
+			seed = CityHash64WithSeed(c, len, seed);
+			c += len;
+			size -= len;
+		}
+		return seed;
+	}
+}
+
+uint64 FVrmLoadCache::GetSceneKey(const aiScene* aiData, const TArray<bool>* SkipTable) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmLoadCache::GetSceneKey"))
+
+	if (aiData == nullptr || aiData->HasTextures() == false) {
+		return 0;
+	}
+	uint64 key = CacheVersion;
+	key = HashBuffer(&aiData->mNumTextures, sizeof(aiData->mNumTextures), key);
+
+	for (uint32_t i = 0; i < aiData->mNumTextures; ++i) {
+		const auto& t = *aiData->mTextures[i];
+
+		// mHeight == 0 : compressed image. mWidth is byte size
+		const uint64 size = (t.mHeight == 0) ? t.mWidth : (uint64)t.mWidth * t.mHeight * sizeof(aiTexel);
+		key = HashBuffer(&t.mWidth, sizeof(t.mWidth), key);
+		key = HashBuffer(&t.mHeight, sizeof(t.mHeight), key);
+		if (t.pcData) {
+			key = HashBuffer(t.pcData, size, key);
+		}
+	}
+	// skipped images are stored empty
+	if (SkipTable && SkipTable->Contains(true)) {
+		key = HashBuffer(SkipTable->GetData(), SkipTable->Num() * sizeof(bool), key);
+	}
+	return key ? key : 1;
+}
+
+bool FVrmLoadCache::Load(uint64 Key, TArray<VRMUtil::FImportImage>& OutImageList) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmLoadCache::Load"))
+
+	if (Key == 0) {
+		return false;
+	}
+	const FString path = GetCacheFilePath(Key);
+
+	// no lock. files are replaced by rename, never rewritten in place
+	TUniquePtr<FArchive> ar(IFileManager::Get().CreateFileReader(*path));
+	if (ar.IsValid() == false) {
+		return false;
+	}
+
+	uint32 magic = 0;
+	uint32 version = 0;
+	uint64 key = 0;
+	int32 num = 0;
+	*ar << magic << version << key << num;
+	if (ar->IsError() || magic != CacheMagic || version != CacheVersion || key != Key || num < 0 || num > 0xffff) {
+		ar.Reset();
+		IFileManager::Get().Delete(*path, false, true, true);
+		return false;
+	}
+
+	OutImageList.Reset();
+	OutImageList.SetNum(num);
+
+	bool bBroken = false;
+	for (auto& img : OutImageList) {
+		int32 format = 0;
+		int32 compression = 0;
+		int32 srgb = 0;
+		int64 size = 0;
+		*ar << format << compression << img.NumMips << img.SizeX << img.SizeY << srgb << size;
+		img.Format = (ETextureSourceFormat)format;
+		if (ar->IsError() || size < 0 || size > ar->TotalSize() - ar->Tell() || IsValidCacheImage(img, size) == false) {
+			bBroken = true;
+			break;
+		}
+		img.CompressionSettings = (TextureCompressionSettings)compression;
+		img.SRGB = srgb != 0;
+		img.RawData.SetNumUninitialized(size);
+		ar->Serialize(img.RawData.GetData(), size);
+	}
+
+	const bool ret = (bBroken == false) && (ar->IsError() == false) && ar->Close();
+	ar.Reset();
+
+	if (ret == false) {
+		OutImageList.Reset();
+		IFileManager::Get().Delete(*path, false, true, true);
+		UE_LOG(LogVRM4ULoader, Warning, TEXT("VRM4U LoadCache: broken file removed %s"), *path);
+		return false;
+	}
+
+	// LRU. timestamp is the last use
+	IFileManager::Get().SetTimeStamp(*path, FDateTime::UtcNow());
+
+	UE_LOG(LogVRM4ULoader, Log, TEXT("VRM4U LoadCache: hit %s"), *path);
+	return true;
+}
+
+bool FVrmLoadCache::Store(uint64 Key, const TArray<VRMUtil::FImportImage>& ImageList, const TArray<bool>* SkipTable) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmLoadCache::Store"))
+
+	if (Key == 0) {
+		return false;
+	}
+	for (int32 i = 0; i < ImageList.Num(); ++i) {
+		if (SkipTable && SkipTable->IsValidIndex(i) && (*SkipTable)[i]) {
+			continue;
+		}
+		// decode failure or a format the loader rejects. don't cache it
+		if (ImageList[i].RawData.Num() == 0 || IsCacheImageFormat(ImageList[i]) == false) {
+			return false;
+		}
+	}
+
+	const FString path = GetCacheFilePath(Key);
+	const FString tmpPath = path + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+
+	{
+		TUniquePtr<FArchive> ar(IFileManager::Get().CreateFileWriter(*tmpPath));
+		if (ar.IsValid() == false) {
+			return false;
+		}
+
+		uint32 magic = CacheMagic;
+		uint32 version = CacheVersion;
+		uint64 key = Key;
+		int32 num = ImageList.Num();
+		*ar << magic << version << key << num;
+
+		for (const auto& img : ImageList) {
+			int32 format = (int32)img.Format;
+			int32 compression = (int32)img.CompressionSettings;
+			int32 mips = img.NumMips;
+			int32 sizeX = img.SizeX;
+			int32 sizeY = img.SizeY;
+			int32 srgb = img.SRGB ? 1 : 0;
+			int64 size = img.RawData.Num();
+			*ar << format << compression << mips << sizeX << sizeY << srgb << size;
+			ar->Serialize((void*)img.RawData.GetData(), size);
+		}
+
+		if (ar->Close() == false) {
+			ar.Reset();
+			IFileManager::Get().Delete(*tmpPath, false, true, true);
+			return false;
+		}
+	}
+
+	FScopeLock lock(&GetCacheLock());
+
+	// rename after write. readers never see a partial file
+	if (IFileManager::Get().Move(*path, *tmpPath, true, true) == false) {
+		IFileManager::Get().Delete(*tmpPath, false, true, true);
+		return false;
+	}
+
+	Trim_Locked();
+	return true;
+}
+
+void FVrmLoadCache::Remove(uint64 Key) {
+	FScopeLock lock(&GetCacheLock());
+	IFileManager::Get().Delete(*GetCacheFilePath(Key), false, true, true);
+}
+
+void FVrmLoadCache::Clear() {
+	FScopeLock lock(&GetCacheLock());
+	IFileManager::Get().DeleteDirectory(*GetCacheDir(), false, true);
+}
+
+void FVrmLoadCache::SetMaxSize(int64 MaxBytes) {
+	FScopeLock lock(&GetCacheLock());
+	CacheMaxSize = FMath::Max<int64>(MaxBytes, 0);
+	Trim_Locked();
+}
+
+int64 FVrmLoadCache::GetMaxSize() {
+	FScopeLock lock(&GetCacheLock());
+	return CacheMaxSize;
+}
+
+FString FVrmLoadCache::GetCacheDir() {
+	return FPaths::ProjectSavedDir() / TEXT("VRM4U") / TEXT("LoadCache");
+}
+
+FString FVrmLoadCache::GetCacheFilePath(uint64 Key) {
+	return GetCacheDir() / FString::Printf(TEXT("%016llx"), Key) + CacheExt;
+}
+
+void FVrmLoadCache::Trim_Locked() {
+	struct FEntry {
+		FString Path;
+		int64 Size;
+		FDateTime Time;
+	};
+
+	const FString dir = GetCacheDir();
+	TArray<FString> files;
+	IFileManager::Get().FindFiles(files, *(dir / (FString(TEXT("*")) + CacheExt)), true, false);
+
+	TArray<FEntry> entryList;
+	int64 total = 0;
+	for (const auto& f : files) {
+		FEntry e;
+		e.Path = dir / f;
+		e.Size = IFileManager::Get().FileSize(*e.Path);
+		e.Time = IFileManager::Get().GetTimeStamp(*e.Path);
+		if (e.Size < 0) {
+			continue;
+		}
+		total += e.Size;
+		entryList.Add(e);
+	}
+	if (total <= CacheMaxSize) {
+		return;
+	}
+
+	// oldest first
+	entryList.Sort([](const FEntry& a, const FEntry& b) {
+		return a.Time < b.Time;
+	});
+	for (const auto& e : entryList) {
+		if (total <= CacheMaxSize) {
+			break;
+		}
+		if (IFileManager::Get().Delete(*e.Path, false, true, true)) {
+			total -= e.Size;
+			UE_LOG(LogVRM4ULoader, Log, TEXT("VRM4U LoadCache: evict %s"), *e.Path);
+		}
+	}
+}
@@ -0,0 +1,36 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VrmUtil.h"
+
+struct aiScene;
+
+/**
+ * On-disk cache of decoded textures for runtime load.
+ * Keyed by the content hash of the embedded images. Files are in Saved/VRM4U/LoadCache.
+ * Thread safe. Load/Store can be called from worker threads.
+ */
+class FVrmLoadCache {
+public:
+	// content hash of all embedded images. 0 == no texture
+	static uint64 GetSceneKey(const aiScene* aiData, const TArray<bool>* SkipTable = nullptr);
+
+	static bool Load(uint64 Key, TArray<VRMUtil::FImportImage>& OutImageList);
+	// images of SkipTable[i] == true (dedup) are stored empty. same table as GetSceneKey
+	static bool Store(uint64 Key, const TArray<VRMUtil::FImportImage>& ImageList, const TArray<bool>* SkipTable = nullptr);
+
+	static void Remove(uint64 Key);
+	static void Clear();
+
+	// least recently used files are removed when the total size is over this
+	static void SetMaxSize(int64 MaxBytes);
+	static int64 GetMaxSize();
+
+	static FString GetCacheDir();
+
+private:
+	static FString GetCacheFilePath(uint64 Key);
+	static void Trim_Locked();
+};
@@ -0,0 +1,142 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmLoadProfile.h"
+#include "VrmAssetListObject.h"
+#include "VrmUtil.h"
+
+#include "HAL/PlatformTime.h"
+#include "HAL/PlatformMemory.h"
+#include "UObject/UObjectArray.h"
+#include "Engine/SkeletalMesh.h"
+#include "Animation/MorphTarget.h"
+
+namespace {
+	thread_local FVrmLoadProfile* s_activeProfile = nullptr;
+
+	// columns of the CSV. other stages are ignored by ToCSV
+	const TCHAR* CSVStageList[] = {
+		TEXT("ReadFile"),
+		TEXT("AssImp"),
+		TEXT("DecodeTexture"),
+		TEXT("ProcessTexture"),
+		TEXT("NormalizeBoneName"),
+		TEXT("ConvertTextureAndMaterial"),
+		TEXT("ConvertVrmMeta"),
+		TEXT("ConvertModel"),
+		TEXT("GenerateLOD"),
+		TEXT("ConvertRig"),
+		TEXT("ConvertIKRig"),
+		TEXT("ConvertMorphTarget"),
+		TEXT("ConvertPose"),
+		TEXT("ConvertHumanoid"),
+		TEXT("Save"),
+	};
+
+	FVrmLoadProfile s_lastProfile;
+
+	float ToMB(uint64 b) {
+		return (float)((double)b / (1024.0 * 1024.0));
+	}
+}
+
+void FVrmLoadProfile::Begin(const FString& InFilePath) {
+	*this = FVrmLoadProfile();
+	FilePath = InFilePath;
+
+	const FPlatformMemoryStats m = FPlatformMemory::GetStats();
+	UsedMemoryBeginMB = ToMB(m.UsedPhysical);
+	ObjectNumBegin = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	StartTime = FPlatformTime::Seconds();
+}
+
+void FVrmLoadProfile::End(const UVrmAssetListObject* Asset, bool bInSuccess) {
+	TotalMs = (float)((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	bSuccess = bInSuccess;
+
+	const FPlatformMemoryStats m = FPlatformMemory::GetStats();
+	UsedMemoryEndMB = ToMB(m.UsedPhysical);
+	PeakMemoryMB = ToMB(m.PeakUsedPhysical);
+	ObjectNum = GUObjectArray.GetObjectArrayNumMinusAvailable() - ObjectNumBegin;
+
+	if (Asset) {
+		TextureNum = Asset->Textures.Num();
+		MaterialNum = Asset->Materials.Num();
+		if (Asset->SkeletalMesh) {
+			BoneNum = VRMGetRefSkeleton(Asset->SkeletalMesh).GetRawBoneNum();
+			MorphTargetNum = VRMGetMorphTargets(Asset->SkeletalMesh).Num();
+		}
+	}
+}
+
+void FVrmLoadProfile::AddStage(const TCHAR* Name, double Seconds) {
+	// same name is accumulated (async texture loop etc)
+	for (auto& s : Stage) {
+		if (s.Name == Name) {
+			s.TimeMs += (float)(Seconds * 1000.0);
+			return;
+		}
+	}
+	FVrmLoadStageTime s;
+	s.Name = Name;
+	s.TimeMs = (float)(Seconds * 1000.0);
+	Stage.Add(s);
+}
+
+float FVrmLoadProfile::GetStageMs(const TCHAR* Name) const {
+	for (const auto& s : Stage) {
+		if (s.Name == Name) {
+			return s.TimeMs;
+		}
+	}
+	return 0.f;
+}
+
+FString FVrmLoadProfile::GetCSVHeader() {
+	FString ret = TEXT("File,Success,FileSizeMB,TotalMs");
+	for (const TCHAR* s : CSVStageList) {
+		ret += FString(TEXT(",")) + s + TEXT("Ms");
+	}
+	ret += TEXT(",UsedMemoryBeginMB,UsedMemoryEndMB,PeakMemoryMB,ObjectNum,TextureNum,MaterialNum,BoneNum,MorphTargetNum,TextureSourceMB,TextureMB,ResizedTextureNum,ACMRBefore,ACMRAfter,BoneWeightErrorMean,BoneWeightErrorMax");
+	return ret;
+}
+
+FString FVrmLoadProfile::ToCSV() const {
+	FString ret = FString::Printf(TEXT("\"%s\",%d,%.2f,%.2f"), *FilePath.Replace(TEXT("\""), TEXT("\"\"")), bSuccess ? 1 : 0, FileSizeMB, TotalMs);
+	for (const TCHAR* s : CSVStageList) {
+		ret += FString::Printf(TEXT(",%.2f"), GetStageMs(s));
+	}
+	ret += FString::Printf(TEXT(",%.1f,%.1f,%.1f,%d,%d,%d,%d,%d,%.1f,%.1f,%d,%.3f,%.3f,%.5f,%.5f"),
+		UsedMemoryBeginMB, UsedMemoryEndMB, PeakMemoryMB,
+		ObjectNum, TextureNum, MaterialNum, BoneNum, MorphTargetNum,
+		TextureSourceMB, TextureMB, ResizedTextureNum,
+		ACMRBefore, ACMRAfter,
+		BoneWeightErrorMean, BoneWeightErrorMax);
+	return ret;
+}
+
+const FVrmLoadProfile& FVrmLoadProfile::GetLastProfile() {
+	return s_lastProfile;
+}
+
+void FVrmLoadProfile::SetLastProfile(const FVrmLoadProfile& Profile) {
+	s_lastProfile = Profile;
+}
+
+FVrmLoadProfileScope::FVrmLoadProfileScope(FVrmLoadProfile& InProfile) {
+	Prev = s_activeProfile;
+	s_activeProfile = &InProfile;
+}
+
+FVrmLoadProfileScope::~FVrmLoadProfileScope() {
+	s_activeProfile = Prev;
+}
+
+FVrmLoadProfile* FVrmLoadProfileScope::Get() {
+	return s_activeProfile;
+}
+
+void FVrmLoadProfileScope::AddStage(const TCHAR* Name, double Seconds) {
+	if (s_activeProfile) {
+		s_activeProfile->AddStage(Name, Seconds);
+	}
+}
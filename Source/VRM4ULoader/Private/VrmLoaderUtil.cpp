@@ -2,6 +2,10 @@
 
 #include "VrmConvert.h"
 #include "VRM4ULoaderLog.h"
+#include "VrmLoadCache.h"
+#include "VrmLoadProfile.h"
+#include "VrmTextureCompress.h"
+#include "VrmTextureMip.h"
 
 #include "CoreMinimal.h"
 #include "UObject/ObjectMacros.h"
@@ -17,7 +21,21 @@
 #include "IImageWrapperModule.h"
 #include "PixelFormat.h"
 #include "RenderUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/ScopeLock.h"
+#include "HAL/CriticalSection.h"
+#include "HAL/PlatformFileManager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#if	UE_VERSION_OLDER_THAN(4,20,0)
+#else
+#include "Async/MappedFileHandle.h"
+#endif
 
+#if	UE_VERSION_OLDER_THAN(4,23,0)
+#define TRACE_CPUPROFILER_EVENT_SCOPE(a)
+#else
+#endif
 
 /////
 
@@ -424,6 +442,371 @@ bool DecompressTGA(
 }
 
 
+namespace {
+	IImageWrapperModule& GetImageWrapperModule() {
+		static const FName ModuleName(TEXT("ImageWrapper"));
+		if (IsInGameThread() == false && FModuleManager::Get().IsModuleLoaded(ModuleName)) {
+			// loading module is game thread only
+			return FModuleManager::GetModuleChecked<IImageWrapperModule>(ModuleName);
+		}
+		return FModuleManager::LoadModuleChecked<IImageWrapperModule>(ModuleName);
+	}
+
+	EImageFormat DetectImageFormat(const void* vBuffer, const size_t Length) {
+		const uint8* p = (const uint8*)vBuffer;
+		if (p == nullptr) {
+			return EImageFormat::Invalid;
+		}
+		if (Length >= 8 && p[0] == 0x89 && p[1] == 'P' && p[2] == 'N' && p[3] == 'G' && p[4] == 0x0D && p[5] == 0x0A && p[6] == 0x1A && p[7] == 0x0A) {
+			return EImageFormat::PNG;
+		}
+		if (Length >= 3 && p[0] == 0xFF && p[1] == 0xD8 && p[2] == 0xFF) {
+			return EImageFormat::JPEG;
+		}
+		if (Length >= 2 && p[0] == 'B' && p[1] == 'M') {
+			return EImageFormat::BMP;
+		}
+		// TGA has no signature. checked by header later
+		return EImageFormat::Invalid;
+	}
+
+	int32 GetImageWrapperSlot(EImageFormat Format) {
+		switch (Format) {
+		case EImageFormat::PNG:		return 0;
+		case EImageFormat::JPEG:	return 1;
+		case EImageFormat::BMP:		return 2;
+		default:
+			break;
+		}
+		return -1;
+	}
+
+	// wrappers of one DecodeSceneTextures call. reused by worker threads, SetCompressed resets the state
+	// wrappers and their buffers are released with the pool
+	class FImageWrapperPool {
+	public:
+		TSharedPtr<IImageWrapper> Acquire(EImageFormat Format) {
+			const int32 slot = GetImageWrapperSlot(Format);
+			if (slot < 0) {
+				return nullptr;
+			}
+			{
+				FScopeLock lock(&Lock);
+				if (FreeList[slot].Num() > 0) {
+					return FreeList[slot].Pop();
+				}
+			}
+			return GetImageWrapperModule().CreateImageWrapper(Format);
+		}
+
+		void Release(EImageFormat Format, const TSharedPtr<IImageWrapper>& Wrapper) {
+			const int32 slot = GetImageWrapperSlot(Format);
+			if (slot < 0 || Wrapper.IsValid() == false) {
+				return;
+			}
+			FScopeLock lock(&Lock);
+			FreeList[slot].Add(Wrapper);
+		}
+
+	private:
+		FCriticalSection Lock;
+		TArray<TSharedPtr<IImageWrapper>> FreeList[3];
+	};
+}
+
+static bool LoadImageFromMemoryLocal(const void* vBuffer, const size_t Length, VRMUtil::FImportImage& OutImage, FImageWrapperPool* Pool);
+
+FVrmMappedFile::FVrmMappedFile() {
+}
+
+FVrmMappedFile::~FVrmMappedFile() {
+	Close();
+}
+
+bool FVrmMappedFile::Open(const FString& filepath) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmMappedFile::Open"))
+	Close();
+
+#if	UE_VERSION_OLDER_THAN(4,20,0)
+#else
+	IPlatformFile& pf = FPlatformFileManager::Get().GetPlatformFile();
+	const int64 size = pf.FileSize(*filepath);
+
+	// pak / some platforms don't support mapping. fall back to file read
+	if (size > 0) {
+#if	UE_VERSION_OLDER_THAN(5,3,0)
+		Handle.Reset(pf.OpenMapped(*filepath));
+#else
+		FOpenMappedResult r = pf.OpenMappedEx(*filepath);
+		if (r.HasValue()) {
+			Handle = r.StealValue();
+		}
+#endif
+		if (Handle.IsValid()) {
+			Region.Reset(Handle->MapRegion(0, size));
+		}
+		if (Region.IsValid() && Region->GetMappedPtr() && Region->GetMappedSize() == size) {
+			return true;
+		}
+		Region.Reset();
+		Handle.Reset();
+	}
+#endif
+
+	return FFileHelper::LoadFileToArray(Buffer, *filepath);
+}
+
+void FVrmMappedFile::Close() {
+	// region first. it refers the handle
+	Region.Reset();
+	Handle.Reset();
+	Buffer.Empty();
+}
+
+const uint8* FVrmMappedFile::GetData() const {
+	if (Region.IsValid()) {
+		return Region->GetMappedPtr();
+	}
+	return Buffer.GetData();
+}
+
+int64 FVrmMappedFile::Num() const {
+	if (Region.IsValid()) {
+		return Region->GetMappedSize();
+	}
+	return Buffer.Num();
+}
+
+void VRMLoaderUtil::DecodeSceneTextures(const aiScene* aiData, TArray<VRMUtil::FImportImage>& OutImageList, bool bUseLoadCache, const TArray<bool>* SkipTable) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM DecodeSceneTextures"))
+
+	OutImageList.Reset();
+	if (aiData == nullptr || aiData->HasTextures() == false) {
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	uint64 cacheKey = 0;
+	if (bUseLoadCache) {
+		cacheKey = FVrmLoadCache::GetSceneKey(aiData, SkipTable);
+		if (FVrmLoadCache::Load(cacheKey, OutImageList) && OutImageList.Num() == (int32)aiData->mNumTextures) {
+			FVrmLoadProfileScope::AddStage(TEXT("DecodeTexture"), FPlatformTime::Seconds() - StartTime);
+			return;
+		}
+		OutImageList.Reset();
+	}
+	OutImageList.SetNum(aiData->mNumTextures);
+
+	GetImageWrapperModule();
+
+	FImageWrapperPool pool;
+	ParallelFor(aiData->mNumTextures, [&](int32 i) {
+		if (SkipTable && SkipTable->IsValidIndex(i) && (*SkipTable)[i]) {
+			return;
+		}
+		const auto& t = *aiData->mTextures[i];
+		if (LoadImageFromMemoryLocal(t.pcData, t.mWidth, OutImageList[i], &pool) == false) {
+			OutImageList[i] = VRMUtil::FImportImage();
+		}
+	});
+
+	FVrmLoadProfileScope::AddStage(TEXT("DecodeTexture"), FPlatformTime::Seconds() - StartTime);
+
+	if (bUseLoadCache) {
+		FVrmLoadCache::Store(cacheKey, OutImageList, SkipTable);
+	}
+}
+
+VRMLoaderUtil::FImageProcessParam VRMLoaderUtil::GetImageProcessParam(const TArray<bool>& NormalTable) {
+	FImageProcessParam Param;
+	Param.NormalTable = NormalTable;
+	Param.bCompress = VRMConverter::Options::Get().IsRuntimeTextureCompress();
+	Param.bBC7Mode = VRMConverter::Options::Get().IsBC7Mode();
+	Param.CompressQuality = VRMConverter::Options::Get().GetRuntimeTextureCompressQuality();
+	Param.bGenerateMips = VRMConverter::Options::Get().IsRuntimeGenerateMips();
+	Param.MaxSize = VRMConverter::Options::Get().GetRuntimeTextureMaxSize();
+	Param.BudgetBytes = (int64)VRMConverter::Options::Get().GetRuntimeTextureBudgetMB() * 1024 * 1024;
+	Param.bDedupTexture = VRMConverter::Options::Get().IsRuntimeTextureDedup();
+	Param.bShareTexture = VRMConverter::Options::Get().IsRuntimeTextureShare();
+	return Param;
+}
+
+void VRMLoaderUtil::ProcessSceneImages(TArray<VRMUtil::FImportImage>& ImageList, const FImageProcessParam& Param) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM ProcessSceneImages"))
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	TArray<int64> sourceSize;
+	sourceSize.SetNumZeroed(ImageList.Num());
+	for (int i = 0; i < ImageList.Num(); ++i) {
+		sourceSize[i] = ImageList[i].RawData.Num();
+	}
+
+	if (Param.bCompress) {
+		for (EPixelFormat f : { PF_DXT1, PF_DXT5, PF_BC5, PF_BC7 }) {
+			if (FVrmTextureCompress::IsSupported(f) == false) {
+				UE_LOG(LogVRM4ULoader, Warning, TEXT("VRM: texture compress. %s is not supported on this platform"), GetPixelFormatString(f));
+			}
+		}
+	}
+
+	// target size of each image. max size, then budget
+	TArray<FIntPoint> targetSize;
+	targetSize.SetNum(ImageList.Num());
+	{
+		auto canResize = [&](int i) {
+			const auto& img = ImageList[i];
+			return img.RawData.Num() > 0 && img.Format == TSF_BGRA8 && img.PixelFormat == PF_B8G8R8A8 && img.NumMips == 1;
+		};
+		// keep multiple of 4 for block compression
+		auto fitSize = [](int32 s, int32 orig) {
+			s = FMath::Max(s, 1);
+			if ((orig % 4) == 0 && s >= 4) {
+				s = s / 4 * 4;
+			}
+			return s;
+		};
+		auto getBytes = [&](const FIntPoint& s) {
+			const int64 b = (int64)s.X * s.Y * 4;
+			return Param.bGenerateMips ? b * 4 / 3 : b;
+		};
+
+		for (int i = 0; i < ImageList.Num(); ++i) {
+			const auto& img = ImageList[i];
+			targetSize[i] = FIntPoint(img.SizeX, img.SizeY);
+			if (canResize(i) == false || Param.MaxSize <= 0) {
+				continue;
+			}
+			const int32 m = FMath::Max(img.SizeX, img.SizeY);
+			if (m > Param.MaxSize) {
+				const double s = (double)Param.MaxSize / m;
+				targetSize[i].X = fitSize(FMath::RoundToInt(img.SizeX * s), img.SizeX);
+				targetSize[i].Y = fitSize(FMath::RoundToInt(img.SizeY * s), img.SizeY);
+			}
+		}
+
+		if (Param.BudgetBytes > 0) {
+			int64 total = 0;
+			for (int i = 0; i < ImageList.Num(); ++i) {
+				if (ImageList[i].RawData.Num() > 0) {
+					total += canResize(i) ? getBytes(targetSize[i]) : ImageList[i].RawData.Num();
+				}
+			}
+			while (total > Param.BudgetBytes) {
+				// halve the largest one
+				int best = -1;
+				for (int i = 0; i < ImageList.Num(); ++i) {
+					if (canResize(i) == false || FMath::Max(targetSize[i].X, targetSize[i].Y) <= 4) {
+						continue;
+					}
+					if (best < 0 || getBytes(targetSize[i]) > getBytes(targetSize[best])) {
+						best = i;
+					}
+				}
+				if (best < 0) {
+					break;
+				}
+				const auto& img = ImageList[best];
+				const FIntPoint s(fitSize(targetSize[best].X / 2, img.SizeX), fitSize(targetSize[best].Y / 2, img.SizeY));
+				total -= getBytes(targetSize[best]) - getBytes(s);
+				targetSize[best] = s;
+			}
+			if (total > Param.BudgetBytes) {
+				UE_LOG(LogVRM4ULoader, Warning, TEXT("VRM: texture budget %.1f MB is too small. %.1f MB"), Param.BudgetBytes / (1024.f * 1024.f), total / (1024.f * 1024.f));
+			}
+		}
+	}
+
+	TArray<FIntPoint> sourceImageSize;
+	sourceImageSize.SetNum(ImageList.Num());
+	for (int i = 0; i < ImageList.Num(); ++i) {
+		sourceImageSize[i] = FIntPoint(ImageList[i].SizeX, ImageList[i].SizeY);
+	}
+
+	FThreadSafeCounter resizeNum;
+	FThreadSafeCounter mipNum;
+
+	ParallelFor(ImageList.Num(), [&](int32 i) {
+		auto& img = ImageList[i];
+		if (img.RawData.Num() == 0) {
+			return;
+		}
+		const bool bNormal = Param.NormalTable.IsValidIndex(i) && Param.NormalTable[i];
+
+		if (targetSize[i].X != img.SizeX || targetSize[i].Y != img.SizeY) {
+			if (FVrmTextureMip::Resize(img, targetSize[i].X, targetSize[i].Y, bNormal)) {
+				resizeNum.Increment();
+			}
+		}
+
+		EPixelFormat format = PF_Unknown;
+		if (Param.bCompress) {
+			format = FVrmTextureCompress::GetFormat(img, bNormal, Param.bBC7Mode);
+			if (FVrmTextureCompress::IsSupported(format) == false) {
+				format = PF_Unknown;
+			}
+		}
+
+		if (format != PF_Unknown && bNormal) {
+			// flip before compression. CreateTextureFromDecodedImage copies block data as is
+			uint8* p = img.RawData.GetData();
+			const int64 num = (int64)img.SizeX * img.SizeY;
+			for (int64 k = 0; k < num; ++k) {
+				p[k * 4 + 1] = 255 - p[k * 4 + 1];
+			}
+		}
+		if (Param.bGenerateMips) {
+			// after flip. renormalize does not depend on the sign of green
+			if (FVrmTextureMip::GenerateMips(img, bNormal)) {
+				mipNum.Increment();
+			}
+		}
+		if (format != PF_Unknown) {
+			FVrmTextureCompress::Compress(img, format, Param.CompressQuality);
+		}
+	});
+
+	int64 totalSource = 0;
+	int64 total = 0;
+	int compressNum = 0;
+	for (int i = 0; i < ImageList.Num(); ++i) {
+		totalSource += sourceSize[i];
+		total += ImageList[i].RawData.Num();
+		if (ImageList[i].PixelFormat != PF_B8G8R8A8) {
+			++compressNum;
+		}
+	}
+	const float toMB = 1.f / (1024.f * 1024.f);
+	if (Param.bCompress) {
+		UE_LOG(LogVRM4ULoader, Log, TEXT("VRM: texture compress %d/%d. %.1f MB -> %.1f MB (saved %.1f MB)"),
+			compressNum, ImageList.Num(), totalSource * toMB, total * toMB, (totalSource - total) * toMB);
+	}
+	if (Param.bGenerateMips) {
+		UE_LOG(LogVRM4ULoader, Log, TEXT("VRM: texture mip generation %d/%d"), mipNum.GetValue(), ImageList.Num());
+	}
+	if (resizeNum.GetValue()) {
+		UE_LOG(LogVRM4ULoader, Log, TEXT("VRM: texture resize %d/%d"), resizeNum.GetValue(), ImageList.Num());
+	}
+
+	if (FVrmLoadProfile* p = FVrmLoadProfileScope::Get()) {
+		p->TextureSourceMB += totalSource * toMB;
+		p->TextureMB += total * toMB;
+		for (int i = 0; i < ImageList.Num(); ++i) {
+			FVrmLoadTextureSize s;
+			s.SourceSizeX = sourceImageSize[i].X;
+			s.SourceSizeY = sourceImageSize[i].Y;
+			s.SizeX = ImageList[i].SizeX;
+			s.SizeY = ImageList[i].SizeY;
+			p->TextureSize.Add(s);
+			if (s.SizeX != s.SourceSizeX || s.SizeY != s.SourceSizeY) {
+				++p->ResizedTextureNum;
+			}
+		}
+	}
+	FVrmLoadProfileScope::AddStage(TEXT("ProcessTexture"), FPlatformTime::Seconds() - StartTime);
+}
+
 UTexture2D* VRMLoaderUtil::CreateTextureFromImage(FString name, UPackage* package, const void* vBuffer, const size_t Length, bool bGenerateMips, bool bNormal, bool bGreenFlip) {
 
 	const char* Buffer = (const char*)vBuffer;
@@ -431,19 +814,28 @@ UTexture2D* VRMLoaderUtil::CreateTextureFromImage(FString name, UPackage* packag
 	if (VRMLoaderUtil::LoadImageFromMemory(Buffer, Length, img) == false) {
 		return nullptr;
 	}
-	UTexture2D *tex = CreateTexture(img.SizeX, img.SizeY, name, package);
+	return CreateTextureFromDecodedImage(name, package, img, bGenerateMips, bNormal, bGreenFlip);
+}
+
+UTexture2D* VRMLoaderUtil::CreateTextureFromDecodedImage(FString name, UPackage* package, const VRMUtil::FImportImage& img, bool bGenerateMips, bool bNormal, bool bGreenFlip) {
+	if (img.RawData.Num() == 0) {
+		return nullptr;
+	}
+	UTexture2D *tex = CreateTexture(img.SizeX, img.SizeY, name, package, img.PixelFormat, img.NumMips);
 
 	if (tex == nullptr) {
 		return nullptr;
 	}
-	{
-		uint8* MipData = (uint8*)GetPlatformData(tex)->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
-		if (bGreenFlip) {
+	for (int32 MipIndex = 0; MipIndex < img.NumMips; ++MipIndex) {
+		auto& Mip = GetPlatformData(tex)->Mips[MipIndex];
+		const uint8* SrcData = (const uint8*)img.GetMipData(MipIndex);
+		uint8* MipData = (uint8*)Mip.BulkData.Lock(LOCK_READ_WRITE);
+		if (bGreenFlip && img.PixelFormat == PF_B8G8R8A8) {
 			//for (int32 y = 0; y < img.SizeY; y++)
-			ParallelFor(img.SizeY, [&](int y) {
-				const uint8* c = img.RawData.GetData() + (y * img.SizeX * sizeof(FColor));
-				uint8* DestPtr = MipData + (y * img.SizeX * sizeof(FColor));
-				for (int32 x = 0; x < img.SizeX; x++)
+			ParallelFor(Mip.SizeY, [&](int y) {
+				const uint8* c = SrcData + (y * Mip.SizeX * sizeof(FColor));
+				uint8* DestPtr = MipData + (y * Mip.SizeX * sizeof(FColor));
+				for (int32 x = 0; x < Mip.SizeX; x++)
 				{
 					DestPtr[0] = c[0];
 					DestPtr[1] = 255 - c[1];
@@ -455,7 +847,7 @@ UTexture2D* VRMLoaderUtil::CreateTextureFromImage(FString name, UPackage* packag
 				}
 				});
 		}else{
-			FMemory::Memcpy(MipData, img.RawData.GetData(), img.RawData.Num());
+			FMemory::Memcpy(MipData, SrcData, FMath::Min<int64>(img.GetMipSize(MipIndex), Mip.BulkData.GetBulkDataSize()));
 		}
 			/*
 			for (int32 y = 0; y < Height; y++)
@@ -472,7 +864,7 @@ UTexture2D* VRMLoaderUtil::CreateTextureFromImage(FString name, UPackage* packag
 				}
 			}
 			*/
-		GetPlatformData(tex)->Mips[0].BulkData.Unlock();
+		Mip.BulkData.Unlock();
 	}
 
 	// Set options
@@ -487,6 +879,10 @@ UTexture2D* VRMLoaderUtil::CreateTextureFromImage(FString name, UPackage* packag
 	}
 	tex->AddressX = TA_Wrap;
 	tex->AddressY = TA_Wrap;
+	if (img.NumMips > 1) {
+		// all mips are in memory. no streaming source
+		tex->NeverStream = true;
+	}
 
 	if (VRMConverter::IsImportMode() == false) {
 		// skip updateresource. call manuary
@@ -505,7 +901,7 @@ UTexture2D* VRMLoaderUtil::CreateTextureFromImage(FString name, UPackage* packag
 	{
 		// alpha check
 		bool noAlpha = true;
-		uint8 *p = img.RawData.GetData();
+		const uint8 *p = img.RawData.GetData();
 		for (int y = 0; y < img.SizeY; ++y) {
 			for (int x = 0; x < img.SizeX; ++x) {
 				if (p[(x + y * img.SizeX) * 4 + 3] != 255) {
@@ -532,8 +928,7 @@ UTexture2D* VRMLoaderUtil::CreateTextureFromImage(FString name, UPackage* packag
 }
 
 
-UTexture2D* VRMLoaderUtil::CreateTexture(int32 InSizeX, int32 InSizeY, FString name, UPackage* package) {
-	auto format = PF_B8G8R8A8;
+UTexture2D* VRMLoaderUtil::CreateTexture(int32 InSizeX, int32 InSizeY, FString name, UPackage* package, EPixelFormat format, int32 NumMips) {
 	UTexture2D* NewTexture = NULL;
 	if (InSizeX > 0 && InSizeY > 0 &&
 		(InSizeX % GPixelFormats[format].BlockSizeX) == 0 &&
@@ -581,19 +976,23 @@ UTexture2D* VRMLoaderUtil::CreateTexture(int32 InSizeX, int32 InSizeY, FString n
 		GetPlatformData(NewTexture)->SizeY = InSizeY;
 		GetPlatformData(NewTexture)->PixelFormat = format;
 
-		int32 NumBlocksX = InSizeX / GPixelFormats[format].BlockSizeX;
-		int32 NumBlocksY = InSizeY / GPixelFormats[format].BlockSizeY;
+		for (int32 MipIndex = 0; MipIndex < FMath::Max(NumMips, 1); ++MipIndex) {
+			const int32 MipSizeX = FMath::Max(InSizeX >> MipIndex, 1);
+			const int32 MipSizeY = FMath::Max(InSizeY >> MipIndex, 1);
+			int32 NumBlocksX = FMath::DivideAndRoundUp(MipSizeX, GPixelFormats[format].BlockSizeX);
+			int32 NumBlocksY = FMath::DivideAndRoundUp(MipSizeY, GPixelFormats[format].BlockSizeY);
 #if	UE_VERSION_OLDER_THAN(4,23,0)
-		FTexture2DMipMap* Mip = new(NewTexture->PlatformData->Mips) FTexture2DMipMap();
+			FTexture2DMipMap* Mip = new(NewTexture->PlatformData->Mips) FTexture2DMipMap();
 #else
-		FTexture2DMipMap* Mip = new FTexture2DMipMap();
-		GetPlatformData(NewTexture)->Mips.Add(Mip);
+			FTexture2DMipMap* Mip = new FTexture2DMipMap();
+			GetPlatformData(NewTexture)->Mips.Add(Mip);
 #endif
-		Mip->SizeX = InSizeX;
-		Mip->SizeY = InSizeY;
-		Mip->BulkData.Lock(LOCK_READ_WRITE);
-		Mip->BulkData.Realloc(NumBlocksX * NumBlocksY * GPixelFormats[format].BlockBytes);
-		Mip->BulkData.Unlock();
+			Mip->SizeX = MipSizeX;
+			Mip->SizeY = MipSizeY;
+			Mip->BulkData.Lock(LOCK_READ_WRITE);
+			Mip->BulkData.Realloc(NumBlocksX * NumBlocksY * GPixelFormats[format].BlockBytes);
+			Mip->BulkData.Unlock();
+		}
 	} else
 	{
 		UE_LOG(LogVRM4ULoader, Warning, TEXT("Invalid parameters specified for UTexture2D::Create()"));
@@ -604,73 +1003,51 @@ UTexture2D* VRMLoaderUtil::CreateTexture(int32 InSizeX, int32 InSizeY, FString n
 
 
 bool VRMLoaderUtil::LoadImageFromMemory(const void* vBuffer, const size_t Length, VRMUtil::FImportImage& OutImage) {
+	FImageWrapperPool pool;
+	return LoadImageFromMemoryLocal(vBuffer, Length, OutImage, &pool);
+}
+
+static bool LoadImageFromMemoryLocal(const void* vBuffer, const size_t Length, VRMUtil::FImportImage& OutImage, FImageWrapperPool* Pool) {
 	const char* Buffer = (const char*)vBuffer;
 
-	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
-	TArray<TSharedPtr<IImageWrapper> > ImageWrapperList = {
-		ImageWrapperModule.CreateImageWrapper(EImageFormat::PNG),
-		ImageWrapperModule.CreateImageWrapper(EImageFormat::JPEG),
-		ImageWrapperModule.CreateImageWrapper(EImageFormat::BMP),
+	const EImageFormat ImageFormat = DetectImageFormat(vBuffer, Length);
+	TSharedPtr<IImageWrapper> ImageWrapper = Pool->Acquire(ImageFormat);
+	ON_SCOPE_EXIT{
+		Pool->Release(ImageFormat, ImageWrapper);
 	};
-
-	TSharedPtr<IImageWrapper> ImageWrapper;
-	for (auto& a : ImageWrapperList) {
-		if (a.IsValid() == false) continue;
-		if (a->SetCompressed(Buffer, Length) == false) continue;
-		ImageWrapper = a;
-		break;
+	if (ImageWrapper.IsValid() && ImageWrapper->SetCompressed(Buffer, Length) == false) {
+		ImageWrapper.Reset();
 	}
 	if (ImageWrapper.IsValid()) {
 
-#if	UE_VERSION_OLDER_THAN(4,25,0)
-#else
+		const int Width = FMath::Max(ImageWrapper->GetWidth(), 1);
+		const int Height = FMath::Max(ImageWrapper->GetHeight(), 1);
+
+#if	UE_VERSION_OLDER_THAN(5,0,0)
 		TArray<uint8> RawData;
-#endif
 		const TArray<uint8>* pRawData = nullptr;
 
 #if	UE_VERSION_OLDER_THAN(4,25,0)
-		if (ImageWrapper.IsValid()) {
-			if (ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, pRawData) == false) return false;
-		}
+		if (ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, pRawData) == false) return false;
 #else
-		if (ImageWrapper.IsValid()) {
-			if (ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData) == false) return false;
-		}
+		if (ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData) == false) return false;
 		pRawData = &RawData;
 #endif
-
-		const int Width = FMath::Max(ImageWrapper->GetWidth(), 1);
-		const int Height = FMath::Max(ImageWrapper->GetHeight(), 1);
 		OutImage.Init2DWithOneMip(Width, Height, TSF_BGRA8);
-
-		{
-			uint8* MipData = (uint8*)OutImage.RawData.GetData();
-			if (ImageWrapper.IsValid()) {
-				if (pRawData) {
-					FMemory::Memcpy(MipData, pRawData->GetData(), pRawData->Num());
-				} else {
-					for (int32 y = 0; y < Height; y++)
-					{
-						const uint8* c = pRawData->GetData() + (y * Width);
-						uint8* DestPtr = &MipData[y * Width * sizeof(FColor)];
-						for (int32 x = 0; x < Width; x++)
-						{
-							*DestPtr++ = c[0];
-							*DestPtr++ = c[1];
-							*DestPtr++ = c[2];
-							*DestPtr++ = c[3];
-							c++;
-						}
-					}
-				}
-			} else {
-				//int no = pmxTexNameList.Num();
-				//MipData[0] = (no & 1 ? 255 : 0);
-				//MipData[1] = (no & 2 ? 255 : 0);
-				//MipData[2] = (no & 4 ? 255 : 0);
-				//MipData[3] = 255;
-			}
+		FMemory::Memcpy(OutImage.RawData.GetData(), pRawData->GetData(), FMath::Min((int64)pRawData->Num(), (int64)OutImage.RawData.Num()));
+#else
+		// decode into the image buffer directly
+		OutImage.RawData.Reset();
+		if (ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, OutImage.RawData) == false) return false;
+
+		OutImage.SizeX = Width;
+		OutImage.SizeY = Height;
+		OutImage.NumMips = 1;
+		OutImage.Format = TSF_BGRA8;
+		if (OutImage.RawData.Num() != (int64)Width * Height * VRMUtil::FImportImage::GetBytesPerPixel(TSF_BGRA8)) {
+			return false;
 		}
+#endif
 		return true;
 	}
 
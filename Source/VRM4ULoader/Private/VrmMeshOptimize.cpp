@@ -0,0 +1,460 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmMeshOptimize.h"
+#include "VRM4ULoaderLog.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/ThreadSafeCounter64.h"
+
+#include <assimp/scene.h>
+#include <assimp/mesh.h>
+
+#if	UE_VERSION_OLDER_THAN(4,23,0)
+#define TRACE_CPUPROFILER_EVENT_SCOPE(a)
+#else
+#endif
+
+namespace {
+	// Forsyth. "Linear-Speed Vertex Cache Optimisation"
+	const int32 ForsythCacheSize = 32;
+	const int32 ForsythValenceMax = 64;
+
+	struct FForsythScore {
+		float Cache[ForsythCacheSize];
+		float Valence[ForsythValenceMax];
+
+		FForsythScore() {
+			for (int i = 0; i < ForsythCacheSize; ++i) {
+				if (i < 3) {
+					// last triangle. fixed score so that it is not reused at once
+					Cache[i] = 0.75f;
+				} else {
+					Cache[i] = FMath::Pow(1.f - (float)(i - 3) / (ForsythCacheSize - 3), 1.5f);
+				}
+			}
+			Valence[0] = -1.f;
+			for (int i = 1; i < ForsythValenceMax; ++i) {
+				Valence[i] = 2.f * FMath::Pow((float)i, -0.5f);
+			}
+		}
+
+		float Get(int32 cachePos, int32 valence) const {
+			if (valence <= 0) {
+				// no triangle left. never selected
+				return -1.f;
+			}
+			float s = (cachePos >= 0) ? Cache[cachePos] : 0.f;
+			s += (valence < ForsythValenceMax) ? Valence[valence] : 2.f * FMath::Pow((float)valence, -0.5f);
+			return s;
+		}
+	};
+
+	const FForsythScore& GetForsythScore() {
+		static const FForsythScore score;
+		return score;
+	}
+
+	template<typename T>
+	void PermuteArray(T* data, int32 num, const TArray<int32>& remap) {
+		if (data == nullptr) {
+			return;
+		}
+		TArray<T> tmp;
+		tmp.Append(data, num);
+		for (int32 i = 0; i < num; ++i) {
+			data[remap[i]] = tmp[i];
+		}
+	}
+
+	bool IsTriangleMesh(const aiMesh* mesh) {
+		if (mesh == nullptr || mesh->mNumFaces == 0 || mesh->mNumVertices == 0 || mesh->mVertices == nullptr) {
+			return false;
+		}
+		for (uint32 f = 0; f < mesh->mNumFaces; ++f) {
+			if (mesh->mFaces[f].mNumIndices != 3) {
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+void FVrmMeshOptimize::OptimizeVertexCache(TArray<uint32>& Indices, int32 VertexNum) {
+	const int32 triNum = Indices.Num() / 3;
+	if (triNum < 2 || VertexNum <= 0) {
+		return;
+	}
+	const FForsythScore& score = GetForsythScore();
+
+	// triangles of each vertex. CSR
+	TArray<int32> valence;
+	TArray<int32> adjStart;
+	TArray<int32> adj;
+	valence.SetNumZeroed(VertexNum);
+	adjStart.SetNumZeroed(VertexNum + 1);
+	for (int32 i = 0; i < triNum * 3; ++i) {
+		++valence[Indices[i]];
+	}
+	for (int32 v = 0; v < VertexNum; ++v) {
+		adjStart[v + 1] = adjStart[v] + valence[v];
+	}
+	adj.SetNumUninitialized(triNum * 3);
+	{
+		TArray<int32> fill;
+		fill.SetNumUninitialized(VertexNum);
+		for (int32 v = 0; v < VertexNum; ++v) {
+			fill[v] = adjStart[v];
+		}
+		for (int32 t = 0; t < triNum; ++t) {
+			for (int k = 0; k < 3; ++k) {
+				adj[fill[Indices[t * 3 + k]]++] = t;
+			}
+		}
+	}
+
+	// valence[v] is the number of triangles not emitted yet. adj[adjStart[v] .. +valence[v]] are them
+	TArray<int32> cachePos;
+	TArray<float> vertexScore;
+	TArray<float> triScore;
+	TArray<bool> emitted;
+	cachePos.Init(-1, VertexNum);
+	vertexScore.SetNumUninitialized(VertexNum);
+	for (int32 v = 0; v < VertexNum; ++v) {
+		vertexScore[v] = score.Get(-1, valence[v]);
+	}
+	triScore.SetNumUninitialized(triNum);
+	emitted.SetNumZeroed(triNum);
+	int32 best = 0;
+	for (int32 t = 0; t < triNum; ++t) {
+		triScore[t] = vertexScore[Indices[t * 3]] + vertexScore[Indices[t * 3 + 1]] + vertexScore[Indices[t * 3 + 2]];
+		if (triScore[t] > triScore[best]) {
+			best = t;
+		}
+	}
+
+	TArray<uint32> out;
+	out.Reserve(Indices.Num());
+
+	int32 cache[ForsythCacheSize + 3];
+	int32 cacheNum = 0;
+	int32 scanPos = 0;
+
+	while (out.Num() < triNum * 3) {
+		if (best < 0) {
+			// dead end. next triangle in the original order
+			while (emitted[scanPos]) {
+				++scanPos;
+			}
+			best = scanPos;
+		}
+		emitted[best] = true;
+
+		const uint32* tri = &Indices[best * 3];
+		out.Add(tri[0]);
+		out.Add(tri[1]);
+		out.Add(tri[2]);
+
+		for (int k = 0; k < 3; ++k) {
+			const int32 v = tri[k];
+			int32* a = &adj[adjStart[v]];
+			for (int32 j = 0; j < valence[v]; ++j) {
+				if (a[j] == best) {
+					Swap(a[j], a[valence[v] - 1]);
+					break;
+				}
+			}
+			--valence[v];
+		}
+
+		// triangle vertices to the front
+		int32 newCache[ForsythCacheSize + 3];
+		int32 newNum = 0;
+		for (int k = 0; k < 3; ++k) {
+			newCache[newNum++] = tri[k];
+		}
+		for (int32 i = 0; i < cacheNum; ++i) {
+			const int32 v = cache[i];
+			if (v != (int32)tri[0] && v != (int32)tri[1] && v != (int32)tri[2]) {
+				newCache[newNum++] = v;
+			}
+		}
+
+		// rescore. vertices pushed out of the cache too
+		for (int32 i = 0; i < newNum; ++i) {
+			const int32 v = newCache[i];
+			cachePos[v] = (i < ForsythCacheSize) ? i : -1;
+			const float s = score.Get(cachePos[v], valence[v]);
+			const float d = s - vertexScore[v];
+			vertexScore[v] = s;
+			for (int32 j = 0; j < valence[v]; ++j) {
+				triScore[adj[adjStart[v] + j]] += d;
+			}
+		}
+
+		cacheNum = FMath::Min(newNum, ForsythCacheSize);
+		FMemory::Memcpy(cache, newCache, sizeof(int32) * cacheNum);
+
+		// best triangle around the cache
+		best = -1;
+		float bestScore = -1.f;
+		for (int32 i = 0; i < cacheNum; ++i) {
+			const int32 v = cache[i];
+			for (int32 j = 0; j < valence[v]; ++j) {
+				const int32 t = adj[adjStart[v] + j];
+				if (triScore[t] > bestScore) {
+					bestScore = triScore[t];
+					best = t;
+				}
+			}
+		}
+	}
+
+	Indices = MoveTemp(out);
+}
+
+void FVrmMeshOptimize::OptimizeOverdraw(TArray<uint32>& Indices, const float* Position, int32 VertexNum) {
+	const int32 triNum = Indices.Num() / 3;
+	if (triNum < 2 || Position == nullptr) {
+		return;
+	}
+
+	// clusters of the cache optimized order. split where the cache is cold again
+	TArray<int32> clusterStart;
+	{
+		TArray<int32> cacheTime;
+		cacheTime.SetNumZeroed(VertexNum);
+		int32 time = ReportCacheSize + 1;
+		for (int32 t = 0; t < triNum; ++t) {
+			int32 miss = 0;
+			for (int k = 0; k < 3; ++k) {
+				const uint32 v = Indices[t * 3 + k];
+				if (time - cacheTime[v] > ReportCacheSize) {
+					cacheTime[v] = time++;
+					++miss;
+				}
+			}
+			if (t == 0 || miss == 3) {
+				clusterStart.Add(t);
+			}
+		}
+		clusterStart.Add(triNum);
+	}
+	const int32 clusterNum = clusterStart.Num() - 1;
+	if (clusterNum < 2) {
+		return;
+	}
+
+	// area weighted centroid and normal
+	auto getTri = [&](int32 t, FVector& p0, FVector& p1, FVector& p2) {
+		const float* a = Position + Indices[t * 3 + 0] * 3;
+		const float* b = Position + Indices[t * 3 + 1] * 3;
+		const float* c = Position + Indices[t * 3 + 2] * 3;
+		p0 = FVector(a[0], a[1], a[2]);
+		p1 = FVector(b[0], b[1], b[2]);
+		p2 = FVector(c[0], c[1], c[2]);
+	};
+
+	FVector meshCenter(0, 0, 0);
+	double meshArea = 0.0;
+	TArray<FVector> clusterCenter;
+	TArray<FVector> clusterNormal;
+	clusterCenter.SetNum(clusterNum);
+	clusterNormal.SetNum(clusterNum);
+	for (int32 c = 0; c < clusterNum; ++c) {
+		FVector center(0, 0, 0);
+		FVector normal(0, 0, 0);
+		double area = 0.0;
+		for (int32 t = clusterStart[c]; t < clusterStart[c + 1]; ++t) {
+			FVector p0, p1, p2;
+			getTri(t, p0, p1, p2);
+			const FVector n = FVector::CrossProduct(p1 - p0, p2 - p0);
+			const double a = n.Size() * 0.5;
+			center += (p0 + p1 + p2) * (a / 3.0);
+			normal += n;
+			area += a;
+		}
+		meshCenter += center;
+		meshArea += area;
+		clusterCenter[c] = (area > 0.0) ? center / area : center;
+		clusterNormal[c] = normal.GetSafeNormal();
+	}
+	if (meshArea > 0.0) {
+		meshCenter /= meshArea;
+	}
+
+	// outward facing and far from the center first. they occlude the rest
+	TArray<int32> order;
+	TArray<float> key;
+	order.SetNumUninitialized(clusterNum);
+	key.SetNumUninitialized(clusterNum);
+	for (int32 c = 0; c < clusterNum; ++c) {
+		order[c] = c;
+		key[c] = FVector::DotProduct(clusterCenter[c] - meshCenter, clusterNormal[c]);
+	}
+	order.StableSort([&key](int32 a, int32 b) {
+		return key[a] > key[b];
+	});
+
+	TArray<uint32> out;
+	out.Reserve(Indices.Num());
+	for (int32 c : order) {
+		out.Append(&Indices[clusterStart[c] * 3], (clusterStart[c + 1] - clusterStart[c]) * 3);
+	}
+	Indices = MoveTemp(out);
+}
+
+void FVrmMeshOptimize::GetVertexFetchRemap(const TArray<uint32>& Indices, int32 VertexNum, TArray<int32>& OutRemap) {
+	OutRemap.Init(-1, VertexNum);
+	int32 next = 0;
+	for (uint32 v : Indices) {
+		if (OutRemap[v] < 0) {
+			OutRemap[v] = next++;
+		}
+	}
+	for (int32 v = 0; v < VertexNum; ++v) {
+		if (OutRemap[v] < 0) {
+			OutRemap[v] = next++;
+		}
+	}
+}
+
+int64 FVrmMeshOptimize::GetCacheMiss(const TArray<uint32>& Indices, int32 VertexNum, int32 CacheSize) {
+	// FIFO. a vertex is in the cache while less than CacheSize misses happened after it
+	TArray<int64> cacheTime;
+	cacheTime.SetNumZeroed(VertexNum);
+	int64 time = CacheSize + 1;
+	int64 miss = 0;
+	for (uint32 v : Indices) {
+		if (time - cacheTime[v] > CacheSize) {
+			cacheTime[v] = time++;
+			++miss;
+		}
+	}
+	return miss;
+}
+
+void FVrmMeshOptimize::OptimizeScene(aiScene* Scene, bool bOverdraw, FVrmMeshOptimizeStat& OutStat) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmMeshOptimize::OptimizeScene"))
+
+	OutStat = FVrmMeshOptimizeStat();
+	if (Scene == nullptr || Scene->HasMeshes() == false) {
+		return;
+	}
+
+	FThreadSafeCounter64 triangleNum;
+	FThreadSafeCounter64 missBefore;
+	FThreadSafeCounter64 missAfter;
+
+	ParallelFor(Scene->mNumMeshes, [&](int32 meshNo) {
+		aiMesh* mesh = Scene->mMeshes[meshNo];
+		if (IsTriangleMesh(mesh) == false) {
+			return;
+		}
+		const int32 vertexNum = mesh->mNumVertices;
+
+		TArray<uint32> indices;
+		indices.SetNumUninitialized(mesh->mNumFaces * 3);
+		for (uint32 f = 0; f < mesh->mNumFaces; ++f) {
+			for (int k = 0; k < 3; ++k) {
+				indices[f * 3 + k] = mesh->mFaces[f].mIndices[k];
+			}
+		}
+		for (uint32 i : indices) {
+			if ((int32)i >= vertexNum) {
+				return;
+			}
+		}
+		const int64 before = GetCacheMiss(indices, vertexNum);
+
+		OptimizeVertexCache(indices, vertexNum);
+		if (bOverdraw) {
+			static_assert(sizeof(aiVector3D) == sizeof(float) * 3, "aiVector3D layout");
+			OptimizeOverdraw(indices, &mesh->mVertices[0].x, vertexNum);
+		}
+
+		// morph targets must have the same vertices to reorder them
+		bool bVertexRemap = true;
+		for (uint32 a = 0; a < mesh->mNumAnimMeshes; ++a) {
+			if (mesh->mAnimMeshes[a] && mesh->mAnimMeshes[a]->mNumVertices != mesh->mNumVertices) {
+				bVertexRemap = false;
+			}
+		}
+
+		if (bVertexRemap) {
+			TArray<int32> remap;
+			GetVertexFetchRemap(indices, vertexNum, remap);
+			for (auto& i : indices) {
+				i = remap[i];
+			}
+
+			PermuteArray(mesh->mVertices, vertexNum, remap);
+			PermuteArray(mesh->mNormals, vertexNum, remap);
+			PermuteArray(mesh->mTangents, vertexNum, remap);
+			PermuteArray(mesh->mBitangents, vertexNum, remap);
+			for (int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+				PermuteArray(mesh->mColors[c], vertexNum, remap);
+			}
+			for (int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+				PermuteArray(mesh->mTextureCoords[c], vertexNum, remap);
+			}
+			for (uint32 a = 0; a < mesh->mNumAnimMeshes; ++a) {
+				aiAnimMesh* am = mesh->mAnimMeshes[a];
+				if (am == nullptr) {
+					continue;
+				}
+				PermuteArray(am->mVertices, vertexNum, remap);
+				PermuteArray(am->mNormals, vertexNum, remap);
+				PermuteArray(am->mTangents, vertexNum, remap);
+				PermuteArray(am->mBitangents, vertexNum, remap);
+				for (int c = 0; c < AI_MAX_NUMBER_OF_COLOR_SETS; ++c) {
+					PermuteArray(am->mColors[c], vertexNum, remap);
+				}
+				for (int c = 0; c < AI_MAX_NUMBER_OF_TEXTURECOORDS; ++c) {
+					PermuteArray(am->mTextureCoords[c], vertexNum, remap);
+				}
+			}
+			for (uint32 b = 0; b < mesh->mNumBones; ++b) {
+				aiBone* bone = mesh->mBones[b];
+				for (uint32 w = 0; w < bone->mNumWeights; ++w) {
+					auto& id = bone->mWeights[w].mVertexId;
+					if ((int32)id < vertexNum) {
+						id = remap[id];
+					}
+				}
+			}
+			for (uint32 s = 0; s < Scene->mNumSkeletons; ++s) {
+				const aiSkeleton* sk = Scene->mSkeletons[s];
+				for (uint32 b = 0; sk && b < sk->mNumBones; ++b) {
+					aiSkeletonBone* bone = sk->mBones[b];
+					if (bone == nullptr || bone->mMeshId != mesh) {
+						continue;
+					}
+					for (uint32 w = 0; w < bone->mNumnWeights; ++w) {
+						auto& id = bone->mWeights[w].mVertexId;
+						if ((int32)id < vertexNum) {
+							id = remap[id];
+						}
+					}
+				}
+			}
+		}
+
+		for (uint32 f = 0; f < mesh->mNumFaces; ++f) {
+			for (int k = 0; k < 3; ++k) {
+				mesh->mFaces[f].mIndices[k] = indices[f * 3 + k];
+			}
+		}
+
+		const int64 after = GetCacheMiss(indices, vertexNum);
+		UE_LOG(LogVRM4ULoader, Verbose, TEXT("OptimizeVertexCache :: mesh %d  ACMR %.3f -> %.3f"), meshNo,
+			(float)before / mesh->mNumFaces, (float)after / mesh->mNumFaces);
+
+		triangleNum.Add(mesh->mNumFaces);
+		missBefore.Add(before);
+		missAfter.Add(after);
+	});
+
+	OutStat.TriangleNum = triangleNum.GetValue();
+	OutStat.MissBefore = missBefore.GetValue();
+	OutStat.MissAfter = missAfter.GetValue();
+}
@@ -0,0 +1,42 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct aiScene;
+
+// cache miss count of a FIFO post-transform cache. ACMR = miss / triangle
+struct FVrmMeshOptimizeStat {
+	int64 TriangleNum = 0;
+	int64 MissBefore = 0;
+	int64 MissAfter = 0;
+
+	float GetACMRBefore() const { return TriangleNum ? (float)MissBefore / TriangleNum : 0.f; }
+	float GetACMRAfter() const { return TriangleNum ? (float)MissAfter / TriangleNum : 0.f; }
+};
+
+/**
+ * Index and vertex order of triangle meshes for GPU vertex cache / fetch locality.
+ * Triangle order: Forsyth linear-speed vertex cache optimization.
+ * Optional overdraw order: clusters sorted outward facing first.
+ */
+class FVrmMeshOptimize {
+public:
+	// FIFO size for the ACMR report
+	static constexpr int32 ReportCacheSize = 16;
+
+	// triangle list. reordered in place
+	static void OptimizeVertexCache(TArray<uint32>& Indices, int32 VertexNum);
+	// Position: xyz per vertex. keeps the order inside each cluster
+	static void OptimizeOverdraw(TArray<uint32>& Indices, const float* Position, int32 VertexNum);
+
+	// old index -> new index. first use order, unused vertices last
+	static void GetVertexFetchRemap(const TArray<uint32>& Indices, int32 VertexNum, TArray<int32>& OutRemap);
+
+	static int64 GetCacheMiss(const TArray<uint32>& Indices, int32 VertexNum, int32 CacheSize = ReportCacheSize);
+
+	// all triangle meshes of the scene. faces, vertices, bone weights and anim meshes are reordered in place.
+	// parallel per mesh. before ConvertModel reads the scene
+	static void OptimizeScene(aiScene* Scene, bool bOverdraw, FVrmMeshOptimizeStat& OutStat);
+};
@@ -0,0 +1,466 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmMeshSimplify.h"
+
+#if	UE_VERSION_OLDER_THAN(4,23,0)
+#define TRACE_CPUPROFILER_EVENT_SCOPE(a)
+#else
+#endif
+
+namespace {
+	enum class EVertexKind : uint8 {
+		Manifold,
+		// one side open. moves only along the border
+		Border,
+		// seam, non manifold, user lock
+		Locked,
+	};
+
+	// plane distance quadric. normalized by the total weight, error is distance^2
+	struct FQuadric {
+		double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+		double b0 = 0, b1 = 0, b2 = 0;
+		double c = 0;
+		double w = 0;
+
+		void AddPlane(double nx, double ny, double nz, double d, double weight) {
+			a00 += weight * nx * nx;
+			a01 += weight * nx * ny;
+			a02 += weight * nx * nz;
+			a11 += weight * ny * ny;
+			a12 += weight * ny * nz;
+			a22 += weight * nz * nz;
+			b0 += weight * nx * d;
+			b1 += weight * ny * d;
+			b2 += weight * nz * d;
+			c += weight * d * d;
+			w += weight;
+		}
+
+		void Add(const FQuadric& q) {
+			a00 += q.a00; a01 += q.a01; a02 += q.a02;
+			a11 += q.a11; a12 += q.a12; a22 += q.a22;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			w += q.w;
+		}
+
+		double Eval(const float* p) const {
+			if (w <= 0.0) {
+				return 0.0;
+			}
+			const double x = p[0], y = p[1], z = p[2];
+			const double r =
+				a00 * x * x + a11 * y * y + a22 * z * z
+				+ 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+				+ 2.0 * (b0 * x + b1 * y + b2 * z)
+				+ c;
+			return FMath::Max(r, 0.0) / w;
+		}
+	};
+
+	struct FCollapse {
+		int32 From;
+		int32 To;
+		double Cost;
+
+		bool operator<(const FCollapse& b) const {
+			return Cost < b.Cost;
+		}
+	};
+
+	FORCEINLINE uint64 EdgeKey(int32 a, int32 b) {
+		return ((uint64)(uint32)a << 32) | (uint32)b;
+	}
+
+	FORCEINLINE const float* GetPos(const FVrmSimplifyMesh& Mesh, int32 v) {
+		return &Mesh.Position[v * 3];
+	}
+
+	void TriangleNormal(const float* p0, const float* p1, const float* p2, double* n) {
+		const double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+		n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+		n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+	}
+
+	double DistSq(const float* a, const float* b) {
+		const double x = a[0] - b[0], y = a[1] - b[1], z = a[2] - b[2];
+		return x * x + y * y + z * z;
+	}
+
+	// 0: same weights  2: no common bone
+	float SkinDistance(const FVrmSimplifyMesh& Mesh, int32 a, int32 b) {
+		const int32 n = Mesh.InfluenceNum;
+		if (n == 0) {
+			return 0.f;
+		}
+		const int32* boneA = &Mesh.SkinBone[a * n];
+		const int32* boneB = &Mesh.SkinBone[b * n];
+		const float* weightA = &Mesh.SkinWeight[a * n];
+		const float* weightB = &Mesh.SkinWeight[b * n];
+
+		float d = 0.f;
+		float matchedB = 0.f;
+		for (int32 i = 0; i < n; ++i) {
+			if (weightA[i] <= 0.f) {
+				continue;
+			}
+			float wb = 0.f;
+			for (int32 j = 0; j < n; ++j) {
+				if (weightB[j] > 0.f && boneB[j] == boneA[i]) {
+					wb = weightB[j];
+					break;
+				}
+			}
+			d += FMath::Abs(weightA[i] - wb);
+			matchedB += wb;
+		}
+		float totalB = 0.f;
+		for (int32 j = 0; j < n; ++j) {
+			totalB += FMath::Max(weightB[j], 0.f);
+		}
+		return d + FMath::Max(totalB - matchedB, 0.f);
+	}
+
+	// vertex -> triangles. CSR
+	struct FAdjacency {
+		TArray<int32> Start;
+		TArray<int32> Tri;
+
+		void Build(const TArray<uint32>& Indices, int32 VertexNum) {
+			Start.Init(0, VertexNum + 1);
+			for (uint32 v : Indices) {
+				++Start[v + 1];
+			}
+			for (int32 v = 0; v < VertexNum; ++v) {
+				Start[v + 1] += Start[v];
+			}
+			Tri.SetNumUninitialized(Indices.Num());
+			TArray<int32> fill;
+			fill.SetNumUninitialized(VertexNum);
+			for (int32 v = 0; v < VertexNum; ++v) {
+				fill[v] = Start[v];
+			}
+			for (int32 i = 0; i < Indices.Num(); ++i) {
+				Tri[fill[Indices[i]]++] = i / 3;
+			}
+		}
+	};
+}
+
+float FVrmMeshSimplify::Simplify(const FVrmSimplifyMesh& Mesh, const TArray<uint32>& Indices, int32 TargetTriangleNum, float SkinWeightScale, TArray<uint32>& OutIndices) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmMeshSimplify::Simplify"))
+
+	OutIndices = Indices;
+
+	const int32 vertexNum = Mesh.GetVertexNum();
+	if (vertexNum == 0 || Indices.Num() / 3 <= TargetTriangleNum) {
+		return 0.f;
+	}
+	for (uint32 v : Indices) {
+		if ((int32)v >= vertexNum) {
+			return 0.f;
+		}
+	}
+
+	// vertices at the same position. split vertices are seams
+	TArray<int32> rep;
+	TArray<int32> groupSize;
+	{
+		TArray<int32> order;
+		order.SetNumUninitialized(vertexNum);
+		for (int32 v = 0; v < vertexNum; ++v) {
+			order[v] = v;
+		}
+		order.Sort([&Mesh](int32 a, int32 b) {
+			const float* pa = GetPos(Mesh, a);
+			const float* pb = GetPos(Mesh, b);
+			if (pa[0] != pb[0]) return pa[0] < pb[0];
+			if (pa[1] != pb[1]) return pa[1] < pb[1];
+			if (pa[2] != pb[2]) return pa[2] < pb[2];
+			return a < b;
+		});
+		rep.SetNumUninitialized(vertexNum);
+		groupSize.Init(1, vertexNum);
+		for (int32 i = 0; i < vertexNum;) {
+			int32 j = i + 1;
+			const float* p = GetPos(Mesh, order[i]);
+			while (j < vertexNum) {
+				const float* q = GetPos(Mesh, order[j]);
+				if (p[0] != q[0] || p[1] != q[1] || p[2] != q[2]) {
+					break;
+				}
+				++j;
+			}
+			for (int32 k = i; k < j; ++k) {
+				rep[order[k]] = order[i];
+				groupSize[order[k]] = j - i;
+			}
+			i = j;
+		}
+	}
+
+	// kind of each vertex. from the original topology
+	TArray<EVertexKind> kind;
+	kind.Init(EVertexKind::Manifold, vertexNum);
+	{
+		TMap<uint64, int32> edge;
+		for (int32 t = 0; t < Indices.Num() / 3; ++t) {
+			for (int k = 0; k < 3; ++k) {
+				const int32 a = rep[Indices[t * 3 + k]];
+				const int32 b = rep[Indices[t * 3 + (k + 1) % 3]];
+				++edge.FindOrAdd(EdgeKey(a, b));
+			}
+		}
+		for (int32 t = 0; t < Indices.Num() / 3; ++t) {
+			for (int k = 0; k < 3; ++k) {
+				const int32 va = Indices[t * 3 + k];
+				const int32 vb = Indices[t * 3 + (k + 1) % 3];
+				const int32 a = rep[va];
+				const int32 b = rep[vb];
+				const int32 count = edge.FindRef(EdgeKey(a, b));
+				const int32 opposite = edge.FindRef(EdgeKey(b, a));
+				if (count > 1 || opposite > 1) {
+					kind[va] = kind[vb] = EVertexKind::Locked;
+				} else if (opposite == 0) {
+					if (kind[va] == EVertexKind::Manifold) kind[va] = EVertexKind::Border;
+					if (kind[vb] == EVertexKind::Manifold) kind[vb] = EVertexKind::Border;
+				}
+			}
+		}
+		for (int32 v = 0; v < vertexNum; ++v) {
+			if (groupSize[v] > 1 || (Mesh.Lock.IsValidIndex(v) && Mesh.Lock[v])) {
+				kind[v] = EVertexKind::Locked;
+			}
+		}
+	}
+
+	// quadric of each vertex. area weighted planes, border edges get a perpendicular plane
+	TArray<FQuadric> quadric;
+	quadric.SetNum(vertexNum);
+	{
+		TSet<uint64> edgeSet;
+		for (int32 t = 0; t < Indices.Num() / 3; ++t) {
+			for (int k = 0; k < 3; ++k) {
+				edgeSet.Add(EdgeKey(rep[Indices[t * 3 + k]], rep[Indices[t * 3 + (k + 1) % 3]]));
+			}
+		}
+		for (int32 t = 0; t < Indices.Num() / 3; ++t) {
+			const uint32* tri = &Indices[t * 3];
+			const float* p[3] = { GetPos(Mesh, tri[0]), GetPos(Mesh, tri[1]), GetPos(Mesh, tri[2]) };
+			double n[3];
+			TriangleNormal(p[0], p[1], p[2], n);
+			const double len = FMath::Sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+			if (len <= 0.0) {
+				continue;
+			}
+			const double area = len * 0.5;
+			n[0] /= len; n[1] /= len; n[2] /= len;
+			const double d = -(n[0] * p[0][0] + n[1] * p[0][1] + n[2] * p[0][2]);
+			for (int k = 0; k < 3; ++k) {
+				quadric[tri[k]].AddPlane(n[0], n[1], n[2], d, area);
+			}
+
+			for (int k = 0; k < 3; ++k) {
+				const int32 va = tri[k];
+				const int32 vb = tri[(k + 1) % 3];
+				if (edgeSet.Contains(EdgeKey(rep[vb], rep[va]))) {
+					continue;
+				}
+				// plane through the border edge, perpendicular to the triangle
+				const float* pa = p[k];
+				const float* pb = p[(k + 1) % 3];
+				double e[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+				double m[3] = { e[1] * n[2] - e[2] * n[1], e[2] * n[0] - e[0] * n[2], e[0] * n[1] - e[1] * n[0] };
+				const double mlen = FMath::Sqrt(m[0] * m[0] + m[1] * m[1] + m[2] * m[2]);
+				if (mlen <= 0.0) {
+					continue;
+				}
+				m[0] /= mlen; m[1] /= mlen; m[2] /= mlen;
+				const double md = -(m[0] * pa[0] + m[1] * pa[1] + m[2] * pa[2]);
+				const double weight = (e[0] * e[0] + e[1] * e[1] + e[2] * e[2]) * 10.0;
+				quadric[va].AddPlane(m[0], m[1], m[2], md, weight);
+				quadric[vb].AddPlane(m[0], m[1], m[2], md, weight);
+			}
+		}
+	}
+
+	TArray<uint32> indices = Indices;
+	FAdjacency adj;
+	TArray<int32> remap;
+	TArray<bool> touched;
+	TArray<int32> mark;
+	TArray<FCollapse> collapse;
+	mark.Init(-1, vertexNum);
+	int32 stamp = 0;
+	double maxCost = 0.0;
+
+	while (indices.Num() / 3 > TargetTriangleNum) {
+		const int32 triNum = indices.Num() / 3;
+		adj.Build(indices, vertexNum);
+
+		TMap<uint64, int32> edge;
+		edge.Reserve(indices.Num());
+		for (int32 t = 0; t < triNum; ++t) {
+			for (int k = 0; k < 3; ++k) {
+				++edge.FindOrAdd(EdgeKey(rep[indices[t * 3 + k]], rep[indices[t * 3 + (k + 1) % 3]]));
+			}
+		}
+		auto isBorderEdge = [&](int32 a, int32 b) {
+			const int32 ab = edge.FindRef(EdgeKey(rep[a], rep[b]));
+			const int32 ba = edge.FindRef(EdgeKey(rep[b], rep[a]));
+			return (ab == 0) != (ba == 0);
+		};
+
+		// cheapest collapse of each vertex
+		collapse.Reset();
+		for (int32 a = 0; a < vertexNum; ++a) {
+			if (kind[a] == EVertexKind::Locked || adj.Start[a] == adj.Start[a + 1]) {
+				continue;
+			}
+			FCollapse best = { a, -1, 0.0 };
+			for (int32 i = adj.Start[a]; i < adj.Start[a + 1]; ++i) {
+				const uint32* tri = &indices[adj.Tri[i] * 3];
+				for (int k = 0; k < 3; ++k) {
+					const int32 b = tri[k];
+					if (b == a) {
+						continue;
+					}
+					if (kind[a] == EVertexKind::Border && isBorderEdge(a, b) == false) {
+						continue;
+					}
+					const float* pb = GetPos(Mesh, b);
+					double cost = quadric[a].Eval(pb);
+					if (SkinWeightScale > 0.f) {
+						cost += SkinWeightScale * SkinDistance(Mesh, a, b) * DistSq(GetPos(Mesh, a), pb);
+					}
+					if (best.To < 0 || cost < best.Cost) {
+						best.To = b;
+						best.Cost = cost;
+					}
+				}
+			}
+			if (best.To >= 0) {
+				collapse.Add(best);
+			}
+		}
+		if (collapse.Num() == 0) {
+			break;
+		}
+		collapse.Sort();
+
+		// half of the remaining reduction per pass. later passes see the updated quadrics
+		const int32 passGoal = FMath::Max((triNum - TargetTriangleNum + 1) / 2, 1);
+		int32 removed = 0;
+		int32 applied = 0;
+
+		remap.SetNumUninitialized(vertexNum);
+		for (int32 v = 0; v < vertexNum; ++v) {
+			remap[v] = v;
+		}
+		touched.Init(false, vertexNum);
+
+		for (int32 c = 0; c < collapse.Num() && removed < passGoal; ++c) {
+			const int32 a = collapse[c].From;
+			const int32 b = collapse[c].To;
+			if (touched[a] || touched[b]) {
+				continue;
+			}
+
+			// link condition. common neighbors must be the opposite vertices of the shared triangles
+			++stamp;
+			int32 shared = 0;
+			for (int32 i = adj.Start[a]; i < adj.Start[a + 1]; ++i) {
+				const uint32* tri = &indices[adj.Tri[i] * 3];
+				if ((int32)tri[0] == b || (int32)tri[1] == b || (int32)tri[2] == b) {
+					++shared;
+				}
+				for (int k = 0; k < 3; ++k) {
+					mark[rep[tri[k]]] = stamp;
+				}
+			}
+			int32 common = 0;
+			{
+				TArray<int32, TInlineAllocator<32>> counted;
+				for (int32 i = adj.Start[b]; i < adj.Start[b + 1]; ++i) {
+					const uint32* tri = &indices[adj.Tri[i] * 3];
+					for (int k = 0; k < 3; ++k) {
+						const int32 r = rep[tri[k]];
+						if (r == rep[a] || r == rep[b] || mark[r] != stamp) {
+							continue;
+						}
+						if (counted.Contains(r) == false) {
+							counted.Add(r);
+							++common;
+						}
+					}
+				}
+			}
+			if (shared == 0 || common > shared) {
+				continue;
+			}
+
+			// no flipped triangle
+			bool bFlip = false;
+			for (int32 i = adj.Start[a]; i < adj.Start[a + 1] && bFlip == false; ++i) {
+				const uint32* tri = &indices[adj.Tri[i] * 3];
+				if ((int32)tri[0] == b || (int32)tri[1] == b || (int32)tri[2] == b) {
+					continue;
+				}
+				const float* p[3];
+				const float* q[3];
+				for (int k = 0; k < 3; ++k) {
+					p[k] = GetPos(Mesh, tri[k]);
+					q[k] = ((int32)tri[k] == a) ? GetPos(Mesh, b) : p[k];
+				}
+				double n0[3], n1[3];
+				TriangleNormal(p[0], p[1], p[2], n0);
+				TriangleNormal(q[0], q[1], q[2], n1);
+				const double dot = n0[0] * n1[0] + n0[1] * n1[1] + n0[2] * n1[2];
+				const double len = FMath::Sqrt((n0[0] * n0[0] + n0[1] * n0[1] + n0[2] * n0[2]) * (n1[0] * n1[0] + n1[1] * n1[1] + n1[2] * n1[2]));
+				if (dot <= 0.25 * len) {
+					bFlip = true;
+				}
+			}
+			if (bFlip) {
+				continue;
+			}
+
+			remap[a] = b;
+			quadric[b].Add(quadric[a]);
+			for (int32 i = adj.Start[a]; i < adj.Start[a + 1]; ++i) {
+				const uint32* tri = &indices[adj.Tri[i] * 3];
+				for (int k = 0; k < 3; ++k) {
+					touched[tri[k]] = true;
+				}
+			}
+			removed += shared;
+			++applied;
+			maxCost = FMath::Max(maxCost, collapse[c].Cost);
+		}
+		if (applied == 0) {
+			break;
+		}
+
+		// apply and remove degenerate triangles
+		int32 out = 0;
+		for (int32 t = 0; t < triNum; ++t) {
+			const uint32 i0 = remap[indices[t * 3 + 0]];
+			const uint32 i1 = remap[indices[t * 3 + 1]];
+			const uint32 i2 = remap[indices[t * 3 + 2]];
+			if (i0 == i1 || i1 == i2 || i2 == i0) {
+				continue;
+			}
+			indices[out * 3 + 0] = i0;
+			indices[out * 3 + 1] = i1;
+			indices[out * 3 + 2] = i2;
+			++out;
+		}
+		indices.SetNum(out * 3);
+	}
+
+	OutIndices = MoveTemp(indices);
+	return (float)FMath::Sqrt(maxCost);
+}
@@ -0,0 +1,33 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// one section. vertex index of Indices is the index of these arrays
+struct FVrmSimplifyMesh {
+	// xyz per vertex
+	TArray<float> Position;
+
+	// InfluenceNum per vertex. bone index is only compared
+	TArray<int32> SkinBone;
+	TArray<float> SkinWeight;
+	int32 InfluenceNum = 0;
+
+	// never removed. morph target vertices etc
+	TArray<bool> Lock;
+
+	int32 GetVertexNum() const { return Position.Num() / 3; }
+};
+
+/**
+ * Quadric error edge collapse for runtime LOD. No editor module.
+ * A vertex only collapses onto a neighbor vertex, so the result uses a subset of the input vertices.
+ * Split vertices (UV / normal seams) and locked vertices are kept, border vertices only move along the border.
+ * Skin weight difference is added to the collapse cost.
+ */
+class FVrmMeshSimplify {
+public:
+	// returns the geometric error (distance) of the worst collapse
+	static float Simplify(const FVrmSimplifyMesh& Mesh, const TArray<uint32>& Indices, int32 TargetTriangleNum, float SkinWeightScale, TArray<uint32>& OutIndices);
+};
@@ -0,0 +1,158 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmSharedAssetRegistry.h"
+#include "VrmAssetListObject.h"
+#include "VrmUtil.h"
+#include "VRM4ULoaderLog.h"
+
+#include "Hash/CityHash.h"
+#include "Misc/ScopeLock.h"
+
+#if	UE_VERSION_OLDER_THAN(4,23,0)
+#define TRACE_CPUPROFILER_EVENT_SCOPE(a)
+#else
+#endif
+
+namespace {
+	FVrmSharedAssetRegistry* s_registry = nullptr;
+}
+
+FVrmSharedAssetRegistry& FVrmSharedAssetRegistry::Get() {
+	if (s_registry == nullptr) {
+		s_registry = new FVrmSharedAssetRegistry();
+	}
+	return *s_registry;
+}
+
+void FVrmSharedAssetRegistry::Shutdown() {
+	delete s_registry;
+	s_registry = nullptr;
+}
+
+FString FVrmSharedAssetRegistry::GetOptionKeyText(const FImportOptionData* Option, const UVrmAssetListObject* InVrmAsset) {
+	FString ret;
+	if (Option) {
+		FImportOptionData::StaticStruct()->ExportText(ret, Option, nullptr, nullptr, PPF_None, nullptr);
+	}
+	if (InVrmAsset) {
+		ret += TEXT("|") + InVrmAsset->GetPathName();
+	}
+	return ret;
+}
+
+uint64 FVrmSharedAssetRegistry::MakeKey(const uint8* pData, int64 DataSize, const FString& OptionKeyText) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmSharedAssetRegistry::MakeKey"))
+
+	if (pData == nullptr || DataSize <= 0) {
+		return 0;
+	}
+	uint64 key = CityHash64((const char*)*OptionKeyText, OptionKeyText.Len() * sizeof(TCHAR));
+	key = CityHash64WithSeed((const char*)&DataSize, sizeof(DataSize), key);
+
+	// CityHash64 takes 32bit length
+	const char* c = (const char*)pData;
+	uint64 size = DataSize;
+	while (size > 0) {
+		const uint32 len = (uint32)FMath::Min<uint64>(size, MAX_uint32);
+		key = CityHash64WithSeed(c, len, key);
+		c += len;
+		size -= len;
+	}
+	return key ? key : 1;
+}
+
+UVrmAssetListObject* FVrmSharedAssetRegistry::Acquire(uint64 Key) {
+	FScopeLock lock(&Lock);
+	return AcquireLocked(Key);
+}
+
+UVrmAssetListObject* FVrmSharedAssetRegistry::AcquireLocked(uint64 Key) {
+	FEntry* e = EntryMap.Find(Key);
+	if (e == nullptr) {
+		return nullptr;
+	}
+	UVrmAssetListObject* a = e->WeakAsset.Get();
+	if (a == nullptr) {
+		EntryMap.Remove(Key);
+		return nullptr;
+	}
+	e->Asset = a;
+	++e->RefCount;
+	UE_LOG(LogVRM4ULoader, Log, TEXT("VRM: shared asset %s. ref=%d"), *a->GetName(), e->RefCount);
+	return a;
+}
+
+UVrmAssetListObject* FVrmSharedAssetRegistry::Register(uint64 Key, UVrmAssetListObject* Asset) {
+	if (Key == 0 || Asset == nullptr) {
+		return Asset;
+	}
+	FScopeLock lock(&Lock);
+
+	// converted by another load meanwhile. keep the live one
+	if (UVrmAssetListObject* a = AcquireLocked(Key)) {
+		return a;
+	}
+
+	// drop released ones
+	for (auto it = EntryMap.CreateIterator(); it; ++it) {
+		if (it->Value.WeakAsset.IsValid() == false) {
+			it.RemoveCurrent();
+		}
+	}
+	FEntry e;
+	e.Asset = Asset;
+	e.WeakAsset = Asset;
+	e.RefCount = 1;
+	EntryMap.Add(Key, e);
+	return Asset;
+}
+
+bool FVrmSharedAssetRegistry::Release(const UVrmAssetListObject* Asset) {
+	if (Asset == nullptr) {
+		return false;
+	}
+	FScopeLock lock(&Lock);
+	for (auto& it : EntryMap) {
+		FEntry& e = it.Value;
+		if (e.WeakAsset.Get() != Asset) {
+			continue;
+		}
+		if (e.RefCount > 0) {
+			--e.RefCount;
+		}
+		if (e.RefCount == 0) {
+			// weak only. reused until GC
+			e.Asset = nullptr;
+		}
+		return true;
+	}
+	return false;
+}
+
+void FVrmSharedAssetRegistry::Clear() {
+	FScopeLock lock(&Lock);
+	EntryMap.Empty();
+}
+
+int32 FVrmSharedAssetRegistry::GetRefCount(const UVrmAssetListObject* Asset) const {
+	FScopeLock lock(&Lock);
+	for (const auto& it : EntryMap) {
+		if (it.Value.WeakAsset.Get() == Asset) {
+			return it.Value.RefCount;
+		}
+	}
+	return 0;
+}
+
+void FVrmSharedAssetRegistry::AddReferencedObjects(FReferenceCollector& Collector) {
+	FScopeLock lock(&Lock);
+	for (auto& it : EntryMap) {
+		if (it.Value.Asset) {
+			Collector.AddReferencedObject(it.Value.Asset);
+		}
+	}
+}
+
+FString FVrmSharedAssetRegistry::GetReferencerName() const {
+	return TEXT("FVrmSharedAssetRegistry");
+}
@@ -0,0 +1,139 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmSkinWeight.h"
+
+namespace {
+	FORCEINLINE void CompareExchange(int32* Bone, float* Weight, int32 a, int32 b) {
+		if (Weight[a] < Weight[b]) {
+			Swap(Weight[a], Weight[b]);
+			Swap(Bone[a], Bone[b]);
+		}
+	}
+}
+
+void FVrmSkinWeight::FVertex::Add(int32 InBone, float InWeight) {
+	if (Num < InputMax) {
+		Bone[Num] = InBone;
+		Weight[Num] = InWeight;
+		++Num;
+		return;
+	}
+	int32 minIndex = 0;
+	for (int32 i = 1; i < InputMax; ++i) {
+		if (Weight[i] < Weight[minIndex]) {
+			minIndex = i;
+		}
+	}
+	if (Weight[minIndex] < InWeight) {
+		Bone[minIndex] = InBone;
+		Weight[minIndex] = InWeight;
+	}
+}
+
+int32 FVrmSkinWeight::GetInfluenceNum(int32 InfluenceNum) {
+	if (InfluenceNum <= 1) return 1;
+	if (InfluenceNum <= 2) return 2;
+	if (InfluenceNum <= 4) return 4;
+	return 8;
+}
+
+void FVrmSkinWeight::Sort(int32* Bone, float* Weight) {
+	// Batcher odd-even merge sort. the sequence does not depend on the data, loops unroll
+	static_assert((InputMax & (InputMax - 1)) == 0, "InputMax must be power of two");
+	for (int32 p = 1; p < InputMax; p <<= 1) {
+		for (int32 k = p; k >= 1; k >>= 1) {
+			for (int32 j = k % p; j + k < InputMax; j += 2 * k) {
+				for (int32 i = 0; i < k && i + j + k < InputMax; ++i) {
+					if ((i + j) / (2 * p) == (i + j + k) / (2 * p)) {
+						CompareExchange(Bone, Weight, i + j, i + j + k);
+					}
+				}
+			}
+		}
+	}
+}
+
+bool FVrmSkinWeight::Process(const FVertex& In, const FVrmSkinWeightParam& Param, int32* OutBone, int32* OutWeight, int32 OutNum, FVrmSkinWeightStat& Stat) {
+	for (int32 i = 0; i < OutNum; ++i) {
+		OutBone[i] = 0;
+		OutWeight[i] = 0;
+	}
+	++Stat.VertexNum;
+
+	int32 bone[InputMax];
+	float weight[InputMax];
+	float total = 0.f;
+	for (int32 i = 0; i < InputMax; ++i) {
+		bone[i] = (i < In.Num) ? In.Bone[i] : 0;
+		weight[i] = (i < In.Num) ? FMath::Max(In.Weight[i], 0.f) : 0.f;
+		total += weight[i];
+	}
+	if (total <= 0.f) {
+		return false;
+	}
+	if (FMath::Abs(total - 1.f) > 0.01f) {
+		++Stat.UnnormalizedVertexNum;
+	}
+
+	Sort(bone, weight);
+
+	// top K
+	const int32 k = FMath::Min3(FMath::Max(Param.InfluenceNum, 1), OutNum, (int32)InputMax);
+	int32 num = FMath::Min(In.Num, k);
+	if (In.Num > k) {
+		++Stat.ReducedVertexNum;
+	}
+
+	// prune. sorted, so cut the tail
+	while (num > 1 && weight[num - 1] / total < Param.PruneThreshold) {
+		--num;
+		++Stat.PrunedNum;
+	}
+
+	// renormalize and quantize. largest remainder keeps the sum exact
+	const int32 quantMax = FMath::Min((Param.QuantizeBits >= 16) ? 65535 : 255, FMath::Max(Param.OutputMax, 1));
+	float kept = 0.f;
+	for (int32 i = 0; i < num; ++i) {
+		kept += weight[i];
+	}
+	int32 q[InputMax];
+	float frac[InputMax];
+	int32 qTotal = 0;
+	for (int32 i = 0; i < num; ++i) {
+		const float f = weight[i] / kept * quantMax;
+		q[i] = FMath::FloorToInt(f);
+		frac[i] = f - q[i];
+		qTotal += q[i];
+	}
+	while (qTotal < quantMax) {
+		int32 best = 0;
+		for (int32 i = 1; i < num; ++i) {
+			if (frac[i] > frac[best]) {
+				best = i;
+			}
+		}
+		++q[best];
+		frac[best] = -1.f;
+		++qTotal;
+	}
+
+	// output. quantMax -> OutputMax is exact for 255 -> 65535 (x257)
+	float error = 0.f;
+	int32 outIndex = 0;
+	for (int32 i = 0; i < In.Num && i < InputMax; ++i) {
+		const float src = weight[i] / total;
+		float dst = 0.f;
+		if (i < num && q[i] > 0) {
+			OutBone[outIndex] = bone[i];
+			OutWeight[outIndex] = (int32)((int64)q[i] * Param.OutputMax / quantMax);
+			dst = (float)q[i] / quantMax;
+			++outIndex;
+		} else if (i < num) {
+			++Stat.PrunedNum;
+		}
+		error += FMath::Abs(src - dst);
+	}
+	Stat.ErrorSum += error;
+	Stat.ErrorMax = FMath::Max(Stat.ErrorMax, error);
+	return true;
+}
@@ -0,0 +1,70 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FVrmSkinWeightParam {
+	// top K influences. 1 - 8
+	int32 InfluenceNum = 8;
+
+	// normalized weights below this are removed before renormalize. the largest one is always kept
+	float PruneThreshold = 0.f;
+
+	// 8: sum 255  16: sum 65535
+	int32 QuantizeBits = 8;
+
+	// sum of the output weights. storage max (255 or 65535)
+	int32 OutputMax = 255;
+};
+
+// error is L1 distance between the input weights (normalized) and the output weights
+struct FVrmSkinWeightStat {
+	int64 VertexNum = 0;
+	// more than K influences
+	int64 ReducedVertexNum = 0;
+	// removed by PruneThreshold or quantized to zero
+	int64 PrunedNum = 0;
+	// input sum is not 1
+	int64 UnnormalizedVertexNum = 0;
+	double ErrorSum = 0.0;
+	float ErrorMax = 0.f;
+
+	void Add(const FVrmSkinWeightStat& s) {
+		VertexNum += s.VertexNum;
+		ReducedVertexNum += s.ReducedVertexNum;
+		PrunedNum += s.PrunedNum;
+		UnnormalizedVertexNum += s.UnnormalizedVertexNum;
+		ErrorSum += s.ErrorSum;
+		ErrorMax = FMath::Max(ErrorMax, s.ErrorMax);
+	}
+	float GetErrorMean() const { return VertexNum ? (float)(ErrorSum / VertexNum) : 0.f; }
+};
+
+/**
+ * Skin weight stage of ConvertModel. Per vertex, no shared state. Call in parallel per section.
+ * Sort (sorting network) -> top K -> prune -> renormalize -> quantize with an exact sum.
+ */
+class FVrmSkinWeight {
+public:
+	static constexpr int32 InputMax = 16;
+
+	// influences of one vertex before the stage
+	struct FVertex {
+		int32 Bone[InputMax];
+		float Weight[InputMax];
+		int32 Num = 0;
+
+		// over InputMax, the smallest one is replaced
+		void Add(int32 InBone, float InWeight);
+	};
+
+	// buffer width for InfluenceNum. 1 / 2 / 4 / 8
+	static int32 GetInfluenceNum(int32 InfluenceNum);
+
+	// descending by weight. fixed compare-exchange sequence
+	static void Sort(int32* Bone, float* Weight);
+
+	// OutBone / OutWeight have OutNum entries. unused entries are zero. false if the vertex has no weight
+	static bool Process(const FVertex& In, const FVrmSkinWeightParam& Param, int32* OutBone, int32* OutWeight, int32 OutNum, FVrmSkinWeightStat& Stat);
+};
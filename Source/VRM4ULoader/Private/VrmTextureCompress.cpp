@@ -0,0 +1,552 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmTextureCompress.h"
+#include "VRM4ULoaderLog.h"
+
+#include "Async/ParallelFor.h"
+#include "PixelFormat.h"
+#include "RenderUtils.h"
+
+#if	UE_VERSION_OLDER_THAN(4,23,0)
+#define TRACE_CPUPROFILER_EVENT_SCOPE(a)
+#else
+#endif
+
+namespace {
+	// 4x4 pixels. r g b a
+	struct FBlock {
+		uint8 c[16][4];
+	};
+
+	// pixels outside the image are clamped. small mips (2x2, 1x1)
+	void LoadBlock(const uint8* BGRA, int32 SizeX, int32 SizeY, int32 bx, int32 by, FBlock& b) {
+		for (int y = 0; y < 4; ++y) {
+			const int32 py = FMath::Min(by * 4 + y, SizeY - 1);
+			const uint8* src = BGRA + (int64)py * SizeX * 4;
+			for (int x = 0; x < 4; ++x) {
+				const int32 px = FMath::Min(bx * 4 + x, SizeX - 1);
+				auto& p = b.c[y * 4 + x];
+				p[0] = src[px * 4 + 2];
+				p[1] = src[px * 4 + 1];
+				p[2] = src[px * 4 + 0];
+				p[3] = src[px * 4 + 3];
+			}
+		}
+	}
+
+	// line through the block colors. first ch channels
+	// quality 0: bounding box  1-: principal axis
+	void FitEndpoints(const FBlock& b, int ch, int quality, float e0[4], float e1[4]) {
+		float mn[4] = { 255, 255, 255, 255 };
+		float mx[4] = { 0, 0, 0, 0 };
+		float mean[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < 16; ++i) {
+			for (int c = 0; c < ch; ++c) {
+				const float v = b.c[i][c];
+				mn[c] = FMath::Min(mn[c], v);
+				mx[c] = FMath::Max(mx[c], v);
+				mean[c] += v;
+			}
+		}
+		for (int c = 0; c < ch; ++c) {
+			mean[c] /= 16.f;
+			e0[c] = mn[c];
+			e1[c] = mx[c];
+		}
+		if (quality == 0) {
+			return;
+		}
+
+		float cov[4][4] = {};
+		for (int i = 0; i < 16; ++i) {
+			float d[4];
+			for (int c = 0; c < ch; ++c) {
+				d[c] = b.c[i][c] - mean[c];
+			}
+			for (int c0 = 0; c0 < ch; ++c0) {
+				for (int c1 = c0; c1 < ch; ++c1) {
+					cov[c0][c1] += d[c0] * d[c1];
+				}
+			}
+		}
+		for (int c0 = 0; c0 < ch; ++c0) {
+			for (int c1 = 0; c1 < c0; ++c1) {
+				cov[c0][c1] = cov[c1][c0];
+			}
+		}
+
+		// power iteration from the bounding box diagonal
+		float axis[4] = { 0, 0, 0, 0 };
+		for (int c = 0; c < ch; ++c) {
+			axis[c] = mx[c] - mn[c];
+		}
+		for (int iter = 0; iter < 8; ++iter) {
+			float t[4] = { 0, 0, 0, 0 };
+			float len = 0.f;
+			for (int c0 = 0; c0 < ch; ++c0) {
+				for (int c1 = 0; c1 < ch; ++c1) {
+					t[c0] += cov[c0][c1] * axis[c1];
+				}
+				len = FMath::Max(len, FMath::Abs(t[c0]));
+			}
+			if (len <= 0.f) {
+				break;
+			}
+			for (int c = 0; c < ch; ++c) {
+				axis[c] = t[c] / len;
+			}
+		}
+		float len2 = 0.f;
+		for (int c = 0; c < ch; ++c) {
+			len2 += axis[c] * axis[c];
+		}
+		if (len2 <= 0.f) {
+			// flat block
+			for (int c = 0; c < ch; ++c) {
+				e0[c] = e1[c] = mean[c];
+			}
+			return;
+		}
+
+		float tmin = FLT_MAX;
+		float tmax = -FLT_MAX;
+		for (int i = 0; i < 16; ++i) {
+			float t = 0.f;
+			for (int c = 0; c < ch; ++c) {
+				t += (b.c[i][c] - mean[c]) * axis[c];
+			}
+			tmin = FMath::Min(tmin, t);
+			tmax = FMath::Max(tmax, t);
+		}
+		tmin /= len2;
+		tmax /= len2;
+		for (int c = 0; c < ch; ++c) {
+			e0[c] = FMath::Clamp(mean[c] + axis[c] * tmin, 0.f, 255.f);
+			e1[c] = FMath::Clamp(mean[c] + axis[c] * tmax, 0.f, 255.f);
+		}
+	}
+
+	// least squares endpoints for fixed weights. w is the weight of e1 (0-1)
+	bool RefineEndpoints(const FBlock& b, int ch, const float w[16], float e0[4], float e1[4]) {
+		float aa = 0, bb = 0, ab = 0;
+		float ax[4] = { 0, 0, 0, 0 };
+		float bx[4] = { 0, 0, 0, 0 };
+		for (int i = 0; i < 16; ++i) {
+			const float beta = w[i];
+			const float alpha = 1.f - beta;
+			aa += alpha * alpha;
+			bb += beta * beta;
+			ab += alpha * beta;
+			for (int c = 0; c < ch; ++c) {
+				ax[c] += alpha * b.c[i][c];
+				bx[c] += beta * b.c[i][c];
+			}
+		}
+		const float denom = aa * bb - ab * ab;
+		if (FMath::Abs(denom) < 1e-6f) {
+			return false;
+		}
+		for (int c = 0; c < ch; ++c) {
+			e0[c] = FMath::Clamp((ax[c] * bb - bx[c] * ab) / denom, 0.f, 255.f);
+			e1[c] = FMath::Clamp((bx[c] * aa - ax[c] * ab) / denom, 0.f, 255.f);
+		}
+		return true;
+	}
+
+	void WriteLE(uint8* out, uint64 v, int bytes) {
+		for (int i = 0; i < bytes; ++i) {
+			out[i] = (uint8)(v >> (i * 8));
+		}
+	}
+
+	///// BC1
+
+	uint16 To565(const float c[3]) {
+		const uint32 r = (uint32)FMath::Clamp(FMath::RoundToInt(c[0] * 31.f / 255.f), 0, 31);
+		const uint32 g = (uint32)FMath::Clamp(FMath::RoundToInt(c[1] * 63.f / 255.f), 0, 63);
+		const uint32 b = (uint32)FMath::Clamp(FMath::RoundToInt(c[2] * 31.f / 255.f), 0, 31);
+		return (uint16)((r << 11) | (g << 5) | b);
+	}
+
+	void From565(uint16 v, int32 out[3]) {
+		const int32 r = (v >> 11) & 31;
+		const int32 g = (v >> 5) & 63;
+		const int32 b = v & 31;
+		out[0] = (r << 3) | (r >> 2);
+		out[1] = (g << 2) | (g >> 4);
+		out[2] = (b << 3) | (b >> 2);
+	}
+
+	// 4 color mode. returns squared error
+	uint32 GetColorIndices(const FBlock& b, uint16 c0, uint16 c1, uint32& indices) {
+		int32 pal[4][3];
+		From565(c0, pal[0]);
+		From565(c1, pal[1]);
+		for (int c = 0; c < 3; ++c) {
+			pal[2][c] = (2 * pal[0][c] + pal[1][c]) / 3;
+			pal[3][c] = (pal[0][c] + 2 * pal[1][c]) / 3;
+		}
+
+		indices = 0;
+		uint32 err = 0;
+		for (int i = 0; i < 16; ++i) {
+			uint32 best = MAX_uint32;
+			uint32 bestIndex = 0;
+			for (uint32 p = 0; p < 4; ++p) {
+				const int32 dr = b.c[i][0] - pal[p][0];
+				const int32 dg = b.c[i][1] - pal[p][1];
+				const int32 db = b.c[i][2] - pal[p][2];
+				const uint32 d = (uint32)(dr * dr + dg * dg + db * db);
+				if (d < best) {
+					best = d;
+					bestIndex = p;
+				}
+			}
+			indices |= bestIndex << (i * 2);
+			err += best;
+		}
+		return err;
+	}
+
+	void EncodeColor(const FBlock& b, int quality, uint8* out) {
+		float e0[4], e1[4];
+		FitEndpoints(b, 3, quality, e0, e1);
+
+		uint16 c0 = To565(e1);
+		uint16 c1 = To565(e0);
+		if (c0 < c1) {
+			Swap(c0, c1);
+		}
+
+		uint32 indices = 0;
+		if (c0 != c1) {
+			uint32 err = GetColorIndices(b, c0, c1, indices);
+
+			if (quality >= 2) {
+				const float weightTable[4] = { 0.f, 1.f, 1.f / 3.f, 2.f / 3.f };
+				float w[16];
+				for (int i = 0; i < 16; ++i) {
+					w[i] = weightTable[(indices >> (i * 2)) & 3];
+				}
+				if (RefineEndpoints(b, 3, w, e0, e1)) {
+					uint16 r0 = To565(e0);
+					uint16 r1 = To565(e1);
+					if (r0 < r1) {
+						Swap(r0, r1);
+					}
+					uint32 rIndices = 0;
+					if (r0 != r1) {
+						const uint32 rErr = GetColorIndices(b, r0, r1, rIndices);
+						if (rErr < err) {
+							c0 = r0;
+							c1 = r1;
+							indices = rIndices;
+						}
+					}
+				}
+			}
+		}
+		WriteLE(out + 0, c0, 2);
+		WriteLE(out + 2, c1, 2);
+		WriteLE(out + 4, indices, 4);
+	}
+
+	///// BC4 (BC3 alpha, BC5)
+
+	void EncodeChannel(const FBlock& b, int ch, uint8* out) {
+		int32 mn = 255;
+		int32 mx = 0;
+		for (int i = 0; i < 16; ++i) {
+			mn = FMath::Min<int32>(mn, b.c[i][ch]);
+			mx = FMath::Max<int32>(mx, b.c[i][ch]);
+		}
+
+		// 8 value mode (a0 > a1)
+		uint64 indices = 0;
+		if (mx != mn) {
+			int32 pal[8];
+			pal[0] = mx;
+			pal[1] = mn;
+			for (int i = 2; i < 8; ++i) {
+				pal[i] = ((8 - i) * mx + (i - 1) * mn) / 7;
+			}
+			for (int i = 0; i < 16; ++i) {
+				int32 best = MAX_int32;
+				uint64 bestIndex = 0;
+				for (int p = 0; p < 8; ++p) {
+					const int32 d = FMath::Abs(b.c[i][ch] - pal[p]);
+					if (d < best) {
+						best = d;
+						bestIndex = p;
+					}
+				}
+				indices |= bestIndex << (i * 3);
+			}
+		}
+		out[0] = (uint8)mx;
+		out[1] = (uint8)mn;
+		WriteLE(out + 2, indices, 6);
+	}
+
+	///// BC7 mode 6. one subset, RGBA 7777 + pbit, 4bit index
+
+	const int32 BC7Weight4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct FBC7Endpoint {
+		int32 q[2][4];	// 7bit
+		int32 p[2];
+	};
+
+	uint32 GetBC7Indices(const FBlock& b, const FBC7Endpoint& ep, uint8 indices[16]) {
+		int32 v[2][4];
+		for (int e = 0; e < 2; ++e) {
+			for (int c = 0; c < 4; ++c) {
+				v[e][c] = (ep.q[e][c] << 1) | ep.p[e];
+			}
+		}
+		int32 pal[16][4];
+		for (int i = 0; i < 16; ++i) {
+			for (int c = 0; c < 4; ++c) {
+				pal[i][c] = ((64 - BC7Weight4[i]) * v[0][c] + BC7Weight4[i] * v[1][c] + 32) >> 6;
+			}
+		}
+
+		float dir[4];
+		float len2 = 0.f;
+		for (int c = 0; c < 4; ++c) {
+			dir[c] = (float)(v[1][c] - v[0][c]);
+			len2 += dir[c] * dir[c];
+		}
+
+		uint32 err = 0;
+		for (int i = 0; i < 16; ++i) {
+			// projection, then the neighbors
+			int32 guess = 0;
+			if (len2 > 0.f) {
+				float t = 0.f;
+				for (int c = 0; c < 4; ++c) {
+					t += (b.c[i][c] - v[0][c]) * dir[c];
+				}
+				guess = FMath::Clamp(FMath::RoundToInt(t / len2 * 15.f), 0, 15);
+			}
+			uint32 best = MAX_uint32;
+			int32 bestIndex = guess;
+			for (int k = FMath::Max(guess - 1, 0); k <= FMath::Min(guess + 1, 15); ++k) {
+				uint32 d = 0;
+				for (int c = 0; c < 4; ++c) {
+					const int32 dc = b.c[i][c] - pal[k][c];
+					d += (uint32)(dc * dc);
+				}
+				if (d < best) {
+					best = d;
+					bestIndex = k;
+				}
+			}
+			indices[i] = (uint8)bestIndex;
+			err += best;
+		}
+		return err;
+	}
+
+	// float endpoints -> 7bit + pbit. all pbit pairs when quality > 0
+	uint32 QuantizeBC7(const FBlock& b, const float e0[4], const float e1[4], int quality, FBC7Endpoint& outEp, uint8 outIndices[16]) {
+		const float* e[2] = { e0, e1 };
+		uint32 bestErr = MAX_uint32;
+		for (int pp = 0; pp < 4; ++pp) {
+			FBC7Endpoint ep;
+			if (quality == 0) {
+				if (pp > 0) {
+					break;
+				}
+				// pbit of the nearest value for each endpoint
+				for (int k = 0; k < 2; ++k) {
+					float d[2] = { 0, 0 };
+					for (int p = 0; p < 2; ++p) {
+						for (int c = 0; c < 4; ++c) {
+							const int32 q = FMath::Clamp(FMath::RoundToInt((e[k][c] - p) * 0.5f), 0, 127);
+							d[p] += FMath::Square(e[k][c] - (float)((q << 1) | p));
+						}
+					}
+					ep.p[k] = d[1] < d[0] ? 1 : 0;
+				}
+			} else {
+				ep.p[0] = pp & 1;
+				ep.p[1] = pp >> 1;
+			}
+			for (int k = 0; k < 2; ++k) {
+				for (int c = 0; c < 4; ++c) {
+					ep.q[k][c] = FMath::Clamp(FMath::RoundToInt((e[k][c] - ep.p[k]) * 0.5f), 0, 127);
+				}
+			}
+
+			uint8 indices[16];
+			const uint32 err = GetBC7Indices(b, ep, indices);
+			if (err < bestErr) {
+				bestErr = err;
+				outEp = ep;
+				FMemory::Memcpy(outIndices, indices, sizeof(indices));
+			}
+		}
+		return bestErr;
+	}
+
+	struct FBitWriter {
+		uint8* out;
+		int32 pos = 0;
+
+		void Write(uint32 v, int32 bits) {
+			for (int i = 0; i < bits; ++i) {
+				if ((v >> i) & 1) {
+					out[pos >> 3] |= (uint8)(1 << (pos & 7));
+				}
+				++pos;
+			}
+		}
+	};
+
+	void EncodeBC7(const FBlock& b, int quality, uint8* out) {
+		float e0[4], e1[4];
+		FitEndpoints(b, 4, quality, e0, e1);
+
+		FBC7Endpoint ep;
+		uint8 indices[16];
+		uint32 err = QuantizeBC7(b, e0, e1, quality, ep, indices);
+
+		if (quality >= 2 && err > 0) {
+			float w[16];
+			for (int i = 0; i < 16; ++i) {
+				w[i] = BC7Weight4[indices[i]] / 64.f;
+			}
+			if (RefineEndpoints(b, 4, w, e0, e1)) {
+				FBC7Endpoint rEp;
+				uint8 rIndices[16];
+				const uint32 rErr = QuantizeBC7(b, e0, e1, quality, rEp, rIndices);
+				if (rErr < err) {
+					ep = rEp;
+					FMemory::Memcpy(indices, rIndices, sizeof(indices));
+				}
+			}
+		}
+
+		// anchor index msb must be 0
+		if (indices[0] & 8) {
+			for (int c = 0; c < 4; ++c) {
+				Swap(ep.q[0][c], ep.q[1][c]);
+			}
+			Swap(ep.p[0], ep.p[1]);
+			for (int i = 0; i < 16; ++i) {
+				indices[i] = 15 - indices[i];
+			}
+		}
+
+		FMemory::Memzero(out, 16);
+		FBitWriter w{ out };
+		w.Write(1 << 6, 7);
+		for (int c = 0; c < 4; ++c) {
+			w.Write(ep.q[0][c], 7);
+			w.Write(ep.q[1][c], 7);
+		}
+		w.Write(ep.p[0], 1);
+		w.Write(ep.p[1], 1);
+		for (int i = 0; i < 16; ++i) {
+			w.Write(indices[i], i == 0 ? 3 : 4);
+		}
+	}
+}
+
+EPixelFormat FVrmTextureCompress::GetFormat(const VRMUtil::FImportImage& Image, bool bNormal, bool bBC7Mode) {
+	if (Image.Format != TSF_BGRA8 || Image.PixelFormat != PF_B8G8R8A8) {
+		return PF_Unknown;
+	}
+	if (Image.SizeX <= 0 || Image.SizeY <= 0 || (Image.SizeX % 4) != 0 || (Image.SizeY % 4) != 0) {
+		return PF_Unknown;
+	}
+	if (bNormal) {
+		return PF_BC5;
+	}
+	if (bBC7Mode) {
+		return PF_BC7;
+	}
+
+	const uint8* p = Image.RawData.GetData();
+	const int64 num = (int64)Image.SizeX * Image.SizeY;
+	for (int64 i = 0; i < num; ++i) {
+		if (p[i * 4 + 3] != 255) {
+			return PF_DXT5;
+		}
+	}
+	return PF_DXT1;
+}
+
+bool FVrmTextureCompress::IsSupported(EPixelFormat Format) {
+	if (Format == PF_Unknown) {
+		return false;
+	}
+	return GPixelFormats[Format].Supported;
+}
+
+bool FVrmTextureCompress::Compress(VRMUtil::FImportImage& Image, EPixelFormat Format, int32 Quality) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmTextureCompress::Compress"))
+
+	if (Format != PF_DXT1 && Format != PF_DXT5 && Format != PF_BC5 && Format != PF_BC7) {
+		return false;
+	}
+	if (Image.Format != TSF_BGRA8 || Image.PixelFormat != PF_B8G8R8A8) {
+		return false;
+	}
+	if (Image.SizeX <= 0 || Image.SizeY <= 0 || (Image.SizeX % 4) != 0 || (Image.SizeY % 4) != 0) {
+		return false;
+	}
+	Quality = FMath::Clamp(Quality, 0, QualityMax);
+
+	const int32 blockBytes = (Format == PF_DXT1) ? 8 : 16;
+
+	// same layout as FImportImage::GetMipSize
+	VRMUtil::FImportImage tmp;
+	tmp.PixelFormat = Format;
+	tmp.SizeX = Image.SizeX;
+	tmp.SizeY = Image.SizeY;
+	tmp.NumMips = Image.NumMips;
+
+	decltype(Image.RawData) dst;
+	dst.SetNumUninitialized(tmp.GetMipOffset(Image.NumMips));
+
+	for (int32 mip = 0; mip < Image.NumMips; ++mip) {
+		const int32 sizeX = FMath::Max(Image.SizeX >> mip, 1);
+		const int32 sizeY = FMath::Max(Image.SizeY >> mip, 1);
+		const int32 blockX = (sizeX + 3) / 4;
+		const int32 blockY = (sizeY + 3) / 4;
+
+		const uint8* src = (const uint8*)Image.GetMipData(mip);
+		uint8* out = dst.GetData() + tmp.GetMipOffset(mip);
+
+		ParallelFor(blockY, [&](int32 by) {
+			FBlock b;
+			for (int32 bx = 0; bx < blockX; ++bx) {
+				LoadBlock(src, sizeX, sizeY, bx, by, b);
+				uint8* o = out + ((int64)by * blockX + bx) * blockBytes;
+
+				switch (Format) {
+				case PF_DXT1:
+					EncodeColor(b, Quality, o);
+					break;
+				case PF_DXT5:
+					EncodeChannel(b, 3, o);
+					EncodeColor(b, Quality, o + 8);
+					break;
+				case PF_BC5:
+					EncodeChannel(b, 0, o);
+					EncodeChannel(b, 1, o + 8);
+					break;
+				default:
+					EncodeBC7(b, Quality, o);
+					break;
+				}
+			}
+		});
+	}
+
+	Image.RawData = MoveTemp(dst);
+	Image.PixelFormat = Format;
+	return true;
+}
@@ -0,0 +1,24 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VrmUtil.h"
+
+/**
+ * CPU block compression of decoded images for runtime load. BC1/BC3/BC5/BC7(mode 6).
+ * No UObject access. Compress can be called from worker threads.
+ */
+class FVrmTextureCompress {
+public:
+	// 0: fast  1: normal  2: high
+	static constexpr int32 QualityMax = 2;
+
+	// normal -> BC5, bBC7Mode -> BC7, alpha -> BC3, otherwise BC1. PF_Unknown if the image can not be compressed
+	static EPixelFormat GetFormat(const VRMUtil::FImportImage& Image, bool bNormal, bool bBC7Mode);
+
+	static bool IsSupported(EPixelFormat Format);
+
+	// BGRA8 -> block data. all mips. Image.RawData and Image.PixelFormat are replaced
+	static bool Compress(VRMUtil::FImportImage& Image, EPixelFormat Format, int32 Quality);
+};
@@ -0,0 +1,175 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmTextureDedup.h"
+#include "VRM4ULoaderLog.h"
+
+#include "Engine/Texture2D.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
+#include "UObject/WeakObjectPtr.h"
+
+#include <assimp/scene.h>
+
+#if	UE_VERSION_OLDER_THAN(4,23,0)
+#define TRACE_CPUPROFILER_EVENT_SCOPE(a)
+#else
+#endif
+
+namespace {
+	TMap<uint64, TWeakObjectPtr<UTexture2D> > s_sharedTexture;
+
+	uint64 GetTextureByteSize(const aiTexture& t) {
+		// mHeight == 0 : compressed image. mWidth is byte size
+		return (t.mHeight == 0) ? t.mWidth : (uint64)t.mWidth * t.mHeight * sizeof(aiTexel);
+	}
+
+	uint64 HashBuffer(const void* p, uint64 size, uint64 seed) {
+		// CityHash64 takes 32bit length
+		const char* c = (const char*)p;
+		while (size > 0) {
+			const uint32 len = (uint32)FMath::Min<uint64>(size, MAX_uint32);
+			seed = CityHash64WithSeed(c, len, seed);
+			c += len;
+			size -= len;
+		}
+		return seed;
+	}
+
+	// everything that changes the created texture except the image itself
+	uint64 GetParamHash(const VRMLoaderUtil::FImageProcessParam& Param, bool bNormal) {
+		const int32 v[] = {
+			bNormal ? 1 : 0,
+			Param.bCompress ? 1 : 0,
+			Param.bBC7Mode ? 1 : 0,
+			Param.CompressQuality,
+			Param.bGenerateMips ? 1 : 0,
+			Param.MaxSize,
+		};
+		return CityHash64((const char*)v, sizeof(v));
+	}
+}
+
+void FVrmTextureDedup::Reset() {
+	Hash.Empty();
+	Remap.Empty();
+	Shared.Empty();
+	SkipDecode.Empty();
+	bShare = false;
+}
+
+void FVrmTextureDedup::Init(const aiScene* aiData, const VRMLoaderUtil::FImageProcessParam& Param) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmTextureDedup::Init"))
+
+	Reset();
+	if (aiData == nullptr || aiData->HasTextures() == false) {
+		return;
+	}
+	const int32 num = aiData->mNumTextures;
+	Hash.SetNumZeroed(num);
+	Remap.SetNum(num);
+	Shared.SetNumZeroed(num);
+	SkipDecode.SetNumZeroed(num);
+	for (int32 i = 0; i < num; ++i) {
+		Remap[i] = i;
+	}
+
+	// texture size depends on all other textures with a budget
+	bShare = Param.bShareTexture && Param.BudgetBytes <= 0;
+	if (Param.bDedupTexture == false && bShare == false) {
+		return;
+	}
+
+	ParallelFor(num, [&](int32 i) {
+		const auto& t = *aiData->mTextures[i];
+		const bool bNormal = Param.NormalTable.IsValidIndex(i) && Param.NormalTable[i];
+		uint64 h = GetParamHash(Param, bNormal);
+		const uint64 size = GetTextureByteSize(t);
+		h = HashBuffer(&size, sizeof(size), h);
+		if (t.pcData) {
+			h = HashBuffer(t.pcData, size, h);
+		}
+		Hash[i] = h;
+	});
+
+	if (Param.bDedupTexture == false) {
+		return;
+	}
+
+	int dupNum = 0;
+	TMap<uint64, int32> first;
+	for (int32 i = 0; i < num; ++i) {
+		const auto& t = *aiData->mTextures[i];
+		if (t.pcData == nullptr) {
+			continue;
+		}
+		const int32* f = first.Find(Hash[i]);
+		if (f == nullptr) {
+			first.Add(Hash[i], i);
+			continue;
+		}
+		// hash collision check
+		const auto& ft = *aiData->mTextures[*f];
+		const uint64 size = GetTextureByteSize(t);
+		if (size != GetTextureByteSize(ft) || FMemory::Memcmp(t.pcData, ft.pcData, size) != 0) {
+			continue;
+		}
+		Remap[i] = *f;
+		SkipDecode[i] = true;
+		++dupNum;
+	}
+	if (dupNum) {
+		UE_LOG(LogVRM4ULoader, Log, TEXT("VRM: texture dedup. %d duplicated textures"), dupNum);
+	}
+}
+
+void FVrmTextureDedup::FindShared(TArray<UTexture2D*>& InOutTextures) {
+	if (bShare == false) {
+		return;
+	}
+	int sharedNum = 0;
+	for (int32 i = 0; i < Hash.Num(); ++i) {
+		if (Remap[i] != i || InOutTextures.IsValidIndex(i) == false) {
+			continue;
+		}
+		const TWeakObjectPtr<UTexture2D>* p = s_sharedTexture.Find(Hash[i]);
+		if (p == nullptr) {
+			continue;
+		}
+		UTexture2D* tex = p->Get();
+		if (tex == nullptr) {
+			s_sharedTexture.Remove(Hash[i]);
+			continue;
+		}
+		InOutTextures[i] = tex;
+		Shared[i] = true;
+		SkipDecode[i] = true;
+		++sharedNum;
+	}
+	if (sharedNum) {
+		UE_LOG(LogVRM4ULoader, Log, TEXT("VRM: texture share. %d textures from cache"), sharedNum);
+	}
+}
+
+bool FVrmTextureDedup::IsCreateTexture(int32 Index) const {
+	if (Remap.IsValidIndex(Index) == false) {
+		return true;
+	}
+	return Remap[Index] == Index && Shared[Index] == false;
+}
+
+void FVrmTextureDedup::AddShared(uint64 Hash, UTexture2D* Texture) {
+	if (Texture == nullptr) {
+		return;
+	}
+	// drop released ones
+	for (auto it = s_sharedTexture.CreateIterator(); it; ++it) {
+		if (it->Value.IsValid() == false) {
+			it.RemoveCurrent();
+		}
+	}
+	s_sharedTexture.Add(Hash, Texture);
+}
+
+void FVrmTextureDedup::ClearShared() {
+	s_sharedTexture.Empty();
+}
@@ -0,0 +1,45 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VrmConvert.h"
+
+struct aiScene;
+class UTexture2D;
+
+/**
+ * Duplicated embedded images of one scene, by content hash of the encoded bytes.
+ * Duplicates are not decoded and share the UTexture2D of the first one.
+ * Optional process-wide cache shares textures between models. weak reference, released by GC.
+ */
+class FVrmTextureDedup {
+public:
+	// content and usage. same hash -> same texture
+	TArray<uint64> Hash;
+
+	// index of the first texture with the same content. Remap[i] == i for unique ones
+	TArray<int32> Remap;
+
+	// texture comes from the process-wide cache
+	TArray<bool> Shared;
+
+	// duplicate or shared. no decode
+	TArray<bool> SkipDecode;
+
+	bool bShare = false;
+
+	void Reset();
+
+	// game thread. hashes are computed in parallel
+	void Init(const aiScene* aiData, const VRMLoaderUtil::FImageProcessParam& Param);
+
+	// game thread. fills InOutTextures[i] for textures found in the process-wide cache
+	void FindShared(TArray<UTexture2D*>& InOutTextures);
+
+	bool IsCreateTexture(int32 Index) const;
+
+	// game thread
+	static void AddShared(uint64 Hash, UTexture2D* Texture);
+	static void ClearShared();
+};
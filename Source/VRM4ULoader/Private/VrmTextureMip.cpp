@@ -0,0 +1,273 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#include "VrmTextureMip.h"
+#include "VRM4ULoaderLog.h"
+
+#include "Async/ParallelFor.h"
+
+#if	UE_VERSION_OLDER_THAN(4,23,0)
+#define TRACE_CPUPROFILER_EVENT_SCOPE(a)
+#else
+#endif
+
+namespace {
+	// srgb <-> linear. linear side is 12bit
+	struct FGammaTable {
+		float ToLinear[256];
+		uint8 ToSRGB[4096];
+
+		FGammaTable() {
+			for (int i = 0; i < 256; ++i) {
+				const float c = i / 255.f;
+				ToLinear[i] = (c <= 0.04045f) ? c / 12.92f : FMath::Pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (int i = 0; i < 4096; ++i) {
+				const float l = i / 4095.f;
+				const float c = (l <= 0.0031308f) ? l * 12.92f : 1.055f * FMath::Pow(l, 1.f / 2.4f) - 0.055f;
+				ToSRGB[i] = (uint8)FMath::Clamp(FMath::RoundToInt(c * 255.f), 0, 255);
+			}
+		}
+
+		uint8 Encode(float l) const {
+			return ToSRGB[FMath::Clamp(FMath::RoundToInt(l * 4095.f), 0, 4095)];
+		}
+	};
+
+	const FGammaTable& GetGammaTable() {
+		static const FGammaTable table;
+		return table;
+	}
+
+	uint8 ToByte(float f) {
+		return (uint8)FMath::Clamp(FMath::RoundToInt(f), 0, 255);
+	}
+
+	float DecodeNormal(uint8 c) {
+		return c / 127.5f - 1.f;
+	}
+
+	// BGRA. R:x G:y B:z
+	void EncodeNormal(float x, float y, float z, uint8* d) {
+		const float len2 = x * x + y * y + z * z;
+		if (len2 > 1.e-8f) {
+			const float inv = FMath::InvSqrt(len2);
+			x *= inv;
+			y *= inv;
+			z *= inv;
+		} else {
+			x = 0.f;
+			y = 0.f;
+			z = 1.f;
+		}
+		d[2] = ToByte((x + 1.f) * 127.5f);
+		d[1] = ToByte((y + 1.f) * 127.5f);
+		d[0] = ToByte((z + 1.f) * 127.5f);
+	}
+
+	// one level. 2x2 box. BGRA8
+	void DownsampleColor(const uint8* src, int32 srcX, int32 srcY, uint8* dst, int32 dstX, int32 dstY) {
+		const FGammaTable& g = GetGammaTable();
+
+		ParallelFor(dstY, [&](int32 y) {
+			const int32 y0 = FMath::Min(y * 2, srcY - 1);
+			const int32 y1 = FMath::Min(y * 2 + 1, srcY - 1);
+			for (int32 x = 0; x < dstX; ++x) {
+				const int32 x0 = FMath::Min(x * 2, srcX - 1);
+				const int32 x1 = FMath::Min(x * 2 + 1, srcX - 1);
+				const uint8* p[4] = {
+					src + ((int64)y0 * srcX + x0) * 4,
+					src + ((int64)y0 * srcX + x1) * 4,
+					src + ((int64)y1 * srcX + x0) * 4,
+					src + ((int64)y1 * srcX + x1) * 4,
+				};
+				uint8* d = dst + ((int64)y * dstX + x) * 4;
+				for (int c = 0; c < 3; ++c) {
+					d[c] = g.Encode((g.ToLinear[p[0][c]] + g.ToLinear[p[1][c]] + g.ToLinear[p[2][c]] + g.ToLinear[p[3][c]]) * 0.25f);
+				}
+				d[3] = (uint8)((p[0][3] + p[1][3] + p[2][3] + p[3][3] + 2) / 4);
+			}
+		});
+	}
+
+	// one level. 2x2 box. BGRA8 normal map
+	void DownsampleNormal(const uint8* src, int32 srcX, int32 srcY, uint8* dst, int32 dstX, int32 dstY) {
+		ParallelFor(dstY, [&](int32 y) {
+			const int32 y0 = FMath::Min(y * 2, srcY - 1);
+			const int32 y1 = FMath::Min(y * 2 + 1, srcY - 1);
+			for (int32 x = 0; x < dstX; ++x) {
+				const int32 x0 = FMath::Min(x * 2, srcX - 1);
+				const int32 x1 = FMath::Min(x * 2 + 1, srcX - 1);
+				const uint8* p[4] = {
+					src + ((int64)y0 * srcX + x0) * 4,
+					src + ((int64)y0 * srcX + x1) * 4,
+					src + ((int64)y1 * srcX + x0) * 4,
+					src + ((int64)y1 * srcX + x1) * 4,
+				};
+				float n[3] = { 0, 0, 0 };
+				int32 a = 0;
+				for (int i = 0; i < 4; ++i) {
+					n[0] += DecodeNormal(p[i][2]);
+					n[1] += DecodeNormal(p[i][1]);
+					n[2] += DecodeNormal(p[i][0]);
+					a += p[i][3];
+				}
+				uint8* d = dst + ((int64)y * dstX + x) * 4;
+				EncodeNormal(n[0], n[1], n[2], d);
+				d[3] = (uint8)((a + 2) / 4);
+			}
+		});
+	}
+
+	// source pixels covered by one destination pixel. weights sum to 1
+	struct FResampleTap {
+		int32 Start = 0;
+		int32 Num = 0;
+		int32 WeightStart = 0;
+	};
+
+	void MakeTaps(int32 srcN, int32 dstN, TArray<FResampleTap>& taps, TArray<float>& weights) {
+		const double scale = (double)srcN / dstN;
+		taps.SetNum(dstN);
+		weights.Reset(0);
+		for (int32 d = 0; d < dstN; ++d) {
+			const double b = d * scale;
+			const double e = (d + 1) * scale;
+			auto& t = taps[d];
+			t.Start = FMath::Clamp((int32)b, 0, srcN - 1);
+			t.Num = FMath::Max(FMath::Min((int32)FMath::CeilToDouble(e), srcN) - t.Start, 1);
+			t.WeightStart = weights.Num();
+			for (int32 s = t.Start; s < t.Start + t.Num; ++s) {
+				const double w = FMath::Min(e, (double)s + 1) - FMath::Max(b, (double)s);
+				weights.Add((float)(FMath::Max(w, 0.0) / scale));
+			}
+		}
+	}
+}
+
+bool FVrmTextureMip::CanGenerateMips(const VRMUtil::FImportImage& Image) {
+	if (Image.Format != TSF_BGRA8 || Image.PixelFormat != PF_B8G8R8A8 || Image.NumMips != 1) {
+		return false;
+	}
+	if (Image.SizeX <= 1 && Image.SizeY <= 1) {
+		return false;
+	}
+	return FMath::IsPowerOfTwo(Image.SizeX) && FMath::IsPowerOfTwo(Image.SizeY);
+}
+
+bool FVrmTextureMip::GenerateMips(VRMUtil::FImportImage& Image, bool bNormal) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmTextureMip::GenerateMips"))
+
+	if (CanGenerateMips(Image) == false) {
+		return false;
+	}
+
+	VRMUtil::FImportImage dst;
+	dst.PixelFormat = Image.PixelFormat;
+	dst.SRGB = Image.SRGB;
+	dst.CompressionSettings = Image.CompressionSettings;
+	dst.Init2DWithMips(Image.SizeX, Image.SizeY, FMath::CeilLogTwo(FMath::Max(Image.SizeX, Image.SizeY)) + 1, Image.Format);
+
+	FMemory::Memcpy(dst.GetMipData(0), Image.RawData.GetData(), dst.GetMipSize(0));
+
+	for (int32 mip = 1; mip < dst.NumMips; ++mip) {
+		const int32 srcX = FMath::Max(dst.SizeX >> (mip - 1), 1);
+		const int32 srcY = FMath::Max(dst.SizeY >> (mip - 1), 1);
+		const int32 dstX = FMath::Max(dst.SizeX >> mip, 1);
+		const int32 dstY = FMath::Max(dst.SizeY >> mip, 1);
+
+		const uint8* s = (const uint8*)dst.GetMipData(mip - 1);
+		uint8* d = (uint8*)dst.GetMipData(mip);
+		if (bNormal) {
+			DownsampleNormal(s, srcX, srcY, d, dstX, dstY);
+		} else {
+			DownsampleColor(s, srcX, srcY, d, dstX, dstY);
+		}
+	}
+
+	Image = MoveTemp(dst);
+	return true;
+}
+
+bool FVrmTextureMip::Resize(VRMUtil::FImportImage& Image, int32 NewSizeX, int32 NewSizeY, bool bNormal) {
+	TRACE_CPUPROFILER_EVENT_SCOPE(TEXT("VRM4U FVrmTextureMip::Resize"))
+
+	if (Image.Format != TSF_BGRA8 || Image.PixelFormat != PF_B8G8R8A8 || Image.NumMips != 1) {
+		return false;
+	}
+	if (NewSizeX <= 0 || NewSizeY <= 0 || NewSizeX > Image.SizeX || NewSizeY > Image.SizeY) {
+		return false;
+	}
+	if (NewSizeX == Image.SizeX && NewSizeY == Image.SizeY) {
+		return true;
+	}
+
+	VRMUtil::FImportImage dst;
+	dst.PixelFormat = Image.PixelFormat;
+	dst.SRGB = Image.SRGB;
+	dst.CompressionSettings = Image.CompressionSettings;
+	dst.Init2DWithOneMip(NewSizeX, NewSizeY, Image.Format);
+
+	ResizeBGRA(Image.RawData.GetData(), Image.SizeX, Image.SizeY, dst.RawData.GetData(), NewSizeX, NewSizeY, bNormal);
+
+	Image = MoveTemp(dst);
+	return true;
+}
+
+void FVrmTextureMip::ResizeBGRA(const uint8* Src, int32 SrcX, int32 SrcY, uint8* Dst, int32 DstX, int32 DstY, bool bNormal) {
+	const FGammaTable& g = GetGammaTable();
+
+	TArray<FResampleTap> tapX, tapY;
+	TArray<float> weightX, weightY;
+	MakeTaps(SrcX, DstX, tapX, weightX);
+	MakeTaps(SrcY, DstY, tapY, weightY);
+
+	// vertical into one source-width row, then horizontal
+	ParallelFor(DstY, [&](int32 y) {
+		TArray<float> row;
+		row.SetNumZeroed(SrcX * 4);
+
+		const auto& ty = tapY[y];
+		for (int32 k = 0; k < ty.Num; ++k) {
+			const float w = weightY[ty.WeightStart + k];
+			const uint8* s = Src + (int64)(ty.Start + k) * SrcX * 4;
+			float* r = row.GetData();
+			if (bNormal) {
+				for (int32 x = 0; x < SrcX; ++x, s += 4, r += 4) {
+					r[0] += DecodeNormal(s[0]) * w;
+					r[1] += DecodeNormal(s[1]) * w;
+					r[2] += DecodeNormal(s[2]) * w;
+					r[3] += s[3] * w;
+				}
+			} else {
+				for (int32 x = 0; x < SrcX; ++x, s += 4, r += 4) {
+					r[0] += g.ToLinear[s[0]] * w;
+					r[1] += g.ToLinear[s[1]] * w;
+					r[2] += g.ToLinear[s[2]] * w;
+					r[3] += s[3] * w;
+				}
+			}
+		}
+
+		uint8* d = Dst + (int64)y * DstX * 4;
+		for (int32 x = 0; x < DstX; ++x, d += 4) {
+			const auto& tx = tapX[x];
+			float c[4] = { 0, 0, 0, 0 };
+			for (int32 k = 0; k < tx.Num; ++k) {
+				const float w = weightX[tx.WeightStart + k];
+				const float* r = &row[(tx.Start + k) * 4];
+				c[0] += r[0] * w;
+				c[1] += r[1] * w;
+				c[2] += r[2] * w;
+				c[3] += r[3] * w;
+			}
+			if (bNormal) {
+				EncodeNormal(c[2], c[1], c[0], d);
+			} else {
+				d[0] = g.Encode(c[0]);
+				d[1] = g.Encode(c[1]);
+				d[2] = g.Encode(c[2]);
+			}
+			d[3] = ToByte(c[3]);
+		}
+	});
+}
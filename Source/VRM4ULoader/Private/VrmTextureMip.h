@@ -0,0 +1,24 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VrmUtil.h"
+
+/**
+ * CPU resampling of decoded images for runtime load. mip chain and downscale.
+ * Color is averaged in linear space, normal map is renormalized.
+ * No UObject access. can be called from worker threads.
+ */
+class FVrmTextureMip {
+public:
+	// power of two BGRA8 image with one mip
+	static bool CanGenerateMips(const VRMUtil::FImportImage& Image);
+
+	// mip0 -> full chain down to 1x1. Image.RawData and Image.NumMips are replaced
+	static bool GenerateMips(VRMUtil::FImportImage& Image, bool bNormal);
+
+	// area filter. any ratio, downscale only. BGRA8 with one mip
+	static bool Resize(VRMUtil::FImportImage& Image, int32 NewSizeX, int32 NewSizeY, bool bNormal);
+	static void ResizeBGRA(const uint8* Src, int32 SrcX, int32 SrcY, uint8* Dst, int32 DstX, int32 DstY, bool bNormal);
+};
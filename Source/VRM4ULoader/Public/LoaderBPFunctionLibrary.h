@@ -5,6 +5,7 @@
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "VrmConvert.h"
 #include "VrmUtil.h"
+#include "VrmLoadProfile.h"
 #include "LoaderBPFunctionLibrary.generated.h"
 
 UENUM(BlueprintType)
@@ -66,6 +67,9 @@ struct FReturnedData
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "ReturnedData")
 		TArray<FMeshInfo_VRM4U> meshInfo;
 
+	// runtime LOD1.. LOD0 vertex -> vertex of the LOD. INDEX_NONE if removed
+	TArray<TArray<int32>> LODVertexRemap;
+
 	//UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "ReturnedData")
 	//TMap<struct aiMesh*, uint32_t> meshToIndex;
 };
@@ -86,18 +90,52 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "VRM4U")
 	static bool VRMSetLoadMaterialType(EVRMImportMaterialType type);
 
+	// runtime load cache (FImportOptionData::bUseLoadCache)
+	UFUNCTION(BlueprintCallable, Category = "VRM4U")
+	static void VRMClearLoadCache();
+
+	UFUNCTION(BlueprintCallable, Category = "VRM4U")
+	static void VRMSetLoadCacheMaxSize(int32 MaxSizeMB = 512);
+
+	// shared asset list (FImportOptionData::bRuntimeShareAsset). call once per load when the instance is removed
+	UFUNCTION(BlueprintCallable, Category = "VRM4U")
+	static bool VRMReleaseSharedAsset(const class UVrmAssetListObject* VrmAsset);
+
+	UFUNCTION(BlueprintCallable, Category = "VRM4U")
+	static void VRMClearSharedAsset();
+
 	UFUNCTION(BlueprintCallable,Category="VRM4U", meta = (DynamicOutputParam = "OutVrmAsset"))
 	static bool LoadVRMFile(const class UVrmAssetListObject *InVrmAsset, class UVrmAssetListObject *&OutVrmAsset, const FString filepath, const FImportOptionData &OptionForRuntimeLoad);
 
 	UFUNCTION(BlueprintCallable, Category = "VRM4U", meta = (Latent, DynamicOutputParam = "OutVrmAsset", WorldContext = "WorldContextObject", LatentInfo = "LatentInfo"))
 	static void LoadVRMFileAsync(const UObject* WorldContextObject, const class UVrmAssetListObject* InVrmAsset, class UVrmAssetListObject*& OutVrmAsset, const FString filepath, const FImportOptionData& OptionForRuntimeLoad, struct FLatentActionInfo LatentInfo);
 
+	// LoadVRMFile with per stage timing / memory report
+	UFUNCTION(BlueprintCallable, Category = "VRM4U", meta = (DynamicOutputParam = "OutVrmAsset"))
+	static bool LoadVRMFileWithProfile(const class UVrmAssetListObject* InVrmAsset, class UVrmAssetListObject*& OutVrmAsset, const FString filepath, const FImportOptionData& OptionForRuntimeLoad, FVrmLoadProfile& OutProfile);
+
+	// report of the last finished LoadVRMFile / LoadVRMFileAsync
+	UFUNCTION(BlueprintCallable, Category = "VRM4U")
+	static void GetLastVRMLoadProfile(FVrmLoadProfile& OutProfile);
+
 
 	static bool LoadVRMFileLocal(const class UVrmAssetListObject* InVrmAsset, class UVrmAssetListObject*& OutVrmAsset, const FString filepath);
 
 	static bool LoadVRMFileFromMemoryDefaultOption(UVrmAssetListObject*& OutVrmAsset, const FString filepath, const uint8* pData, size_t dataSize);
 	static bool LoadVRMFileFromMemory(const UVrmAssetListObject* InVrmAsset, UVrmAssetListObject*& OutVrmAsset, const FString filepath, const uint8* pFileData, size_t dataSize);
 
+	// set model type (vrm0/vrm1/vrma/bvh/pmx) to VRMConverter::Options. returns extension for assimp
+	// OutJson: vrm/glb/gltf/vrma json parsed for the type check. pass it to LoadVRMFileFromScene to skip the second parse
+	static FString SetVRMModelType(const FString filepath, const uint8* pFileData, size_t dataSize, VrmJson* OutJson = nullptr);
+	// assimp parse only. no UObject access, can run on worker thread
+	// bSkipCompleteAttribute: vrm/glb. normal/tangent generation is requested only when some primitive does not have them
+	// Json: parsed by SetVRMModelType. the attribute check is skipped without it
+	static const aiScene* ReadVRMScene(Assimp::Importer& Importer, const FString ImporterExt, const FString filepath, const uint8* pFileData, size_t dataSize, bool bSkipCompleteAttribute = false, const VrmJson* Json = nullptr);
+	// convert parsed scene. OutVrmAsset is reused if not null (keeps preloaded textures)
+	// DecodedImageList: result of VRMLoaderUtil::DecodeSceneTextures for pScene. images are moved out
+	// ParsedJson: from SetVRMModelType. moved out
+	static bool LoadVRMFileFromScene(const UVrmAssetListObject* InVrmAsset, UVrmAssetListObject*& OutVrmAsset, const FString filepath, const uint8* pFileData, size_t dataSize, const aiScene* pScene, TArray<VRMUtil::FImportImage>* DecodedImageList = nullptr, VrmJson* ParsedJson = nullptr);
+
 	static void SetImportMode(bool bImportMode, class UPackage *package);
 
 	//static void SetCopySkeletalMeshAnimation(bool bImportMode, class UPackage *package);
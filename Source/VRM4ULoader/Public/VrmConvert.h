@@ -38,6 +38,8 @@ class UVrmAssetListObject;
 class UVrmLicenseObject;
 class UVrm1LicenseObject;
 class UPackage;
+class IMappedFileHandle;
+class IMappedFileRegion;
 
 
 class VRM4ULOADER_API VRMConverter {
@@ -46,6 +48,9 @@ public:
 	VrmJson jsonData;
 	const aiScene* aiData = nullptr;
 
+	// images decoded before conversion (batch import). used instead of DecodeSceneTextures if set
+	TArray<VRMUtil::FImportImage>* DecodedImageList = nullptr;
+
 	char* GetMatName(int matNo) const;
 	char* GetMatShaderName(int matNo) const;
 	int GetMatNum() const;
@@ -64,13 +69,16 @@ public:
 
 	static bool NormalizeBoneName(const aiScene *mScenePtr);
 
-	bool Init(const uint8* pFileData, size_t dataSize, const aiScene*);
+	// ParsedJson: json of pFileData parsed by the caller. moved to jsonData
+	bool Init(const uint8* pFileData, size_t dataSize, const aiScene*, VrmJson* ParsedJson = nullptr);
 
 	bool ConvertTextureAndMaterial(UVrmAssetListObject *vrmAssetList);
 	bool ConvertModel(UVrmAssetListObject *vrmAssetList);
 	bool ConvertMorphTarget(UVrmAssetListObject *vrmAssetList);
 
 	void GetVRMMeta(const aiScene *mScenePtr, UVrmLicenseObject *& a, UVrm1LicenseObject *& b);
+	// license from jsonData only. no assimp scene. ThumbnailImage is glTF image index
+	bool GetVRMMetaFromJson(UVrmLicenseObject*& a, UVrm1LicenseObject*& b, int& ThumbnailImage) const;
 	bool ConvertVrmFirst(UVrmAssetListObject* vrmAssetList, const uint8* pData, size_t dataSize);
 	bool ConvertVrmMeta(UVrmAssetListObject *vrmAssetList, const aiScene *mScenePtr, const uint8* pData, size_t dataSize);
 	bool ConvertVrmMetaPost(UVrmAssetListObject* vrmAssetList, const aiScene* mScenePtr, const uint8* pData, size_t dataSize);
@@ -84,8 +92,18 @@ public:
 
 	class VRM4ULOADER_API Options {
 	public:
+		// options of the running load. global one if no Scope is active on this thread
 		static Options & Get();
 
+		// activate per-load options on the current thread
+		class VRM4ULOADER_API Scope {
+		public:
+			Scope(Options &o);
+			~Scope();
+		private:
+			Options *prev = nullptr;
+		};
+
 		const FImportOptionData *ImportOption = nullptr;
 		void SetVrmOption(const FImportOptionData *p) {
 			ImportOption = p;
@@ -128,6 +146,8 @@ public:
 		bool IsMobileBone() const;
 
 		int GetBoneWeightInfluenceNum() const;
+		float GetBoneWeightPruneThreshold() const;
+		bool IsBoneWeight8Bit() const;
 
 		bool IsForceOpaque() const;
 		bool IsForceTwoSided() const;
@@ -137,6 +157,19 @@ public:
 		bool IsDefaultGridTextureMode() const;
 		bool IsBC7Mode() const;
 		bool IsMipmapGenerateMode() const;
+		bool IsLoadCache() const;
+		bool IsSkipCompleteAttributeGeneration() const;
+		bool IsRuntimeTextureCompress() const;
+		int GetRuntimeTextureCompressQuality() const;
+		bool IsRuntimeGenerateMips() const;
+		int GetRuntimeTextureMaxSize() const;
+		int GetRuntimeTextureBudgetMB() const;
+		bool IsRuntimeTextureDedup() const;
+		bool IsRuntimeTextureShare() const;
+		bool IsRuntimeShareAsset() const;
+		int GetRuntimeLODNum() const;
+		float GetRuntimeLODTriangleRatio(int LODIndex) const;
+		float GetRuntimeLODScreenSize(int LODIndex) const;
 
 		bool IsGenerateOutlineMaterial() const;
 		bool IsMergeMaterial() const;
@@ -148,6 +181,8 @@ public:
 		bool IsOptimizeVertex() const;
 
 		bool IsRemoveDegenerateTriangles() const;
+		bool IsOptimizeVertexCache() const;
+		bool IsOptimizeOverdraw() const;
 
 		void ClearModelType();
 
@@ -183,15 +218,73 @@ public:
 
 		EVRMImportMaterialType GetMaterialType() const;
 		void SetMaterialType(EVRMImportMaterialType type);
+
+	private:
+		bool bbVRM0 = false;
+		bool bbVRM10 = false;
+		bool bbVRMA = false;
+		bool bbBVH = false;
+		bool bbPMX = false;
+		bool bbNoMesh = false;
+		EVRMImportMaterialType mType = EVRMImportMaterialType::VRMIMT_Auto;
 	};
 };
 
 class VRM4ULOADER_API VRMLoaderUtil {
 public:
-	static UTexture2D* CreateTexture(int32 InSizeX, int32 InSizeY, FString name, UPackage* package);
+	static UTexture2D* CreateTexture(int32 InSizeX, int32 InSizeY, FString name, UPackage* package, EPixelFormat format = PF_B8G8R8A8, int32 NumMips = 1);
 	static UTexture2D* CreateTextureFromImage(FString name, UPackage* package, const void* Buffer, const size_t Length, bool GenerateMip = false, bool bNormal = false, bool bNormalGreenFlip = false);
+	// game thread. create texture from decoded image
+	static UTexture2D* CreateTextureFromDecodedImage(FString name, UPackage* package, const VRMUtil::FImportImage& img, bool GenerateMip = false, bool bNormal = false, bool bNormalGreenFlip = false);
 
 	static bool LoadImageFromMemory(const void* Buffer, const size_t Length, VRMUtil::FImportImage& OutImage);
+
+	// decode all embedded textures in parallel. no UObject access, can run on worker thread
+	// images of SkipTable[i] == true are left empty
+	static void DecodeSceneTextures(const aiScene* aiData, TArray<VRMUtil::FImportImage>& OutImageList, bool bUseLoadCache = false, const TArray<bool>* SkipTable = nullptr);
+
+	// runtime load. processing of decoded images before texture creation
+	struct FImageProcessParam {
+		TArray<bool> NormalTable;
+		bool bCompress = false;
+		bool bBC7Mode = false;
+		int32 CompressQuality = 1;
+		bool bGenerateMips = false;
+		int32 MaxSize = 0;
+		int64 BudgetBytes = 0;
+		bool bDedupTexture = false;
+		bool bShareTexture = false;
+	};
+	// from VRMConverter::Options. game thread
+	static FImageProcessParam GetImageProcessParam(const TArray<bool>& NormalTable);
+	// no UObject access, can run on worker thread. resize, mips, compression. green of compressed normal map is flipped here
+	static void ProcessSceneImages(TArray<VRMUtil::FImportImage>& ImageList, const FImageProcessParam& Param);
+};
+
+// read-only view of a model file.
+// memory mapped when the platform supports it, otherwise loaded into memory
+class VRM4ULOADER_API FVrmMappedFile {
+public:
+	FVrmMappedFile();
+	~FVrmMappedFile();
+
+	bool Open(const FString& filepath);
+	void Close();
+
+	const uint8* GetData() const;
+	int64 Num() const;
+
+	bool IsMapped() const {
+		return Region.IsValid();
+	}
+
+private:
+	FVrmMappedFile(const FVrmMappedFile&) = delete;
+	FVrmMappedFile& operator=(const FVrmMappedFile&) = delete;
+
+	TUniquePtr<IMappedFileHandle> Handle;
+	TUniquePtr<IMappedFileRegion> Region;
+	TArray<uint8> Buffer;
 };
 
 
@@ -13,7 +13,32 @@ class VrmJson {
 public:
 	RAPIDJSON_NAMESPACE::Document doc;
 
+	VrmJson() = default;
+	// hand over a parsed json. the source becomes disabled
+	VrmJson& operator=(VrmJson&& src) {
+		doc = static_cast<RAPIDJSON_NAMESPACE::Document&&>(src.doc);
+		bEnable = src.bEnable;
+		src.bEnable = false;
+		return *this;
+	}
+
+	// GLB or gltf text. parsed from the original memory without copy
 	bool init(const uint8_t* pData, size_t size);
+
+	// json text only (GLB JSON chunk). not null terminated
+	bool initJson(const char* pJson, size_t size);
+
+	// images[imageIndex] -> bufferView of buffer 0. offset is relative to the BIN chunk
+	bool GetImageBufferView(int imageIndex, size_t& offset, size_t& length) const;
+
+	// VRMC_vrm or VRMC_vrm_animation
+	bool IsVRM10() const;
+
+	// every mesh primitive has the attribute. "NORMAL", "TANGENT"
+	bool HasPrimitiveAttribute(const char* name) const;
+
+	// GLB header and chunk headers. pointers are into pData. gltf text returns whole data as json
+	static bool GetGLBChunk(const uint8_t* pData, size_t size, const char*& json, size_t& jsonSize, const uint8_t*& bin, size_t& binSize);
 	
 	bool IsEnable() const{
 		return bEnable;
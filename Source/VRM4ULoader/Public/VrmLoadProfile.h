@@ -0,0 +1,158 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "VrmLoadProfile.generated.h"
+
+USTRUCT(BlueprintType)
+struct VRM4ULOADER_API FVrmLoadStageTime {
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	FString Name;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float TimeMs = 0.f;
+};
+
+// decoded size and the size actually used. differs when the texture is downscaled
+USTRUCT(BlueprintType)
+struct VRM4ULOADER_API FVrmLoadTextureSize {
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 SourceSizeX = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 SourceSizeY = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 SizeX = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 SizeY = 0;
+};
+
+/**
+ * Timing and memory report of one model load.
+ * Stages are in execution order. Memory is in MB.
+ */
+USTRUCT(BlueprintType)
+struct VRM4ULOADER_API FVrmLoadProfile {
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	FString FilePath;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	bool bSuccess = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float FileSizeMB = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	TArray<FVrmLoadStageTime> Stage;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float TotalMs = 0.f;
+
+	// process physical memory
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float UsedMemoryBeginMB = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float UsedMemoryEndMB = 0.f;
+
+	// process lifetime peak. only meaningful for the first load of the process
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float PeakMemoryMB = 0.f;
+
+	// UObjects created by the load
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 ObjectNum = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 TextureNum = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 MaterialNum = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 BoneNum = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 MorphTargetNum = 0;
+
+	// texture memory. decoded BGRA8 and the size actually uploaded (after compression etc)
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float TextureSourceMB = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float TextureMB = 0.f;
+
+	// same order as the scene textures
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	TArray<FVrmLoadTextureSize> TextureSize;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	int32 ResizedTextureNum = 0;
+
+	// asset list is from FVrmSharedAssetRegistry. nothing was converted
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	bool bSharedAsset = false;
+
+	// average cache miss per triangle (16 entry FIFO). bOptimizeVertexCache only
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float ACMRBefore = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float ACMRAfter = 0.f;
+
+	// triangles of each LOD. LOD1.. are bRuntimeGenerateLOD
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	TArray<int32> LODTriangleNum;
+
+	// L1 distance of the source and the stored skin weights per vertex
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float BoneWeightErrorMean = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "VRM4U")
+	float BoneWeightErrorMax = 0.f;
+
+	void Begin(const FString& InFilePath);
+	void End(const class UVrmAssetListObject* Asset, bool bInSuccess);
+
+	void AddStage(const TCHAR* Name, double Seconds);
+	float GetStageMs(const TCHAR* Name) const;
+
+	// fixed column layout. missing stages are written as 0
+	static FString GetCSVHeader();
+	FString ToCSV() const;
+
+	// last finished load (sync or async). game thread
+	static const FVrmLoadProfile& GetLastProfile();
+	static void SetLastProfile(const FVrmLoadProfile& Profile);
+
+private:
+	int32 ObjectNumBegin = 0;
+	double StartTime = 0.0;
+};
+
+/**
+ * Binds a profile to the current thread. stages reported by the loader go to it.
+ */
+class VRM4ULOADER_API FVrmLoadProfileScope {
+public:
+	FVrmLoadProfileScope(FVrmLoadProfile& InProfile);
+	~FVrmLoadProfileScope();
+
+	// null if no profile is bound to this thread
+	static FVrmLoadProfile* Get();
+
+	static void AddStage(const TCHAR* Name, double Seconds);
+
+private:
+	FVrmLoadProfile* Prev = nullptr;
+};
@@ -0,0 +1,55 @@
+// VRM4U Copyright (c) 2021-2024 Haruyoshi Yamamoto. This software is released under the MIT License.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/GCObject.h"
+#include "UObject/WeakObjectPtr.h"
+#include "HAL/CriticalSection.h"
+
+class UVrmAssetListObject;
+struct FImportOptionData;
+
+/**
+ * Runtime load. converted asset lists shared by file content and load options.
+ * Skeletal mesh, skeleton, textures and materials are shared. dynamic material instances
+ * and spring bone state are per component and created for each instance as before.
+ * Referenced while acquired, weak after the last release (reused until GC).
+ * Entries are locked. converted assets are game thread objects.
+ */
+class VRM4ULOADER_API FVrmSharedAssetRegistry : public FGCObject {
+public:
+	static FVrmSharedAssetRegistry& Get();
+	static void Shutdown();
+
+	// game thread. options and template asset as text
+	static FString GetOptionKeyText(const FImportOptionData* Option, const UVrmAssetListObject* InVrmAsset);
+	// any thread
+	static uint64 MakeKey(const uint8* pData, int64 DataSize, const FString& OptionKeyText);
+
+	// null if not registered or already released by GC. ref count +1
+	UVrmAssetListObject* Acquire(uint64 Key);
+	// acquire or register in one step. if a live entry exists, ref count +1 and returns it (Asset is not used).
+	// otherwise Asset is registered with ref count 1 and returned
+	UVrmAssetListObject* Register(uint64 Key, UVrmAssetListObject* Asset);
+	// ref count -1. false if not registered
+	bool Release(const UVrmAssetListObject* Asset);
+
+	void Clear();
+	int32 GetRefCount(const UVrmAssetListObject* Asset) const;
+
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
+	virtual FString GetReferencerName() const override;
+
+private:
+	struct FEntry {
+		// strong while RefCount > 0
+		UVrmAssetListObject* Asset = nullptr;
+		TWeakObjectPtr<UVrmAssetListObject> WeakAsset;
+		int32 RefCount = 0;
+	};
+	TMap<uint64, FEntry> EntryMap;
+	mutable FCriticalSection Lock;
+
+	UVrmAssetListObject* AcquireLocked(uint64 Key);
+};